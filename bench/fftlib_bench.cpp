@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <string_view>
+
+#include "fftlib.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+void Usage()
+{
+	std::cerr << "fftlib_bench, times FFT processor construction and transformation\n";
+	std::cerr << "Usage : fftlib_bench [-Ln] [-Hn] [-Wn] [-Bn] [-Tn] [-J]\n";
+	std::cerr << "Options. -Ln, lowest FFT width 2^n to measure, default " << FFTWdMin << "\n";
+	std::cerr << "         -Hn, highest FFT width 2^n to measure, default " << FFTWdMax << "\n";
+	std::cerr << "         -Wn, only measure window n (codes as fftit), default all windows\n";
+	std::cerr << "         -Bn, frames per batch in the batched case, default 8\n";
+	std::cerr << "         -Tn, minimum milliseconds spent on each measurement, default 200\n";
+	std::cerr << "         -J,  write JSON rather than CSV\n";
+	std::cerr << "Results go to stdout, one record per width, window and mode.\n";
+	std::cerr << "gflops counts 5N.log2(N) operations per transform, bytes/s counts input samples read.\n\n";
+}
+
+struct result_t
+{
+	size_t           width;
+	window_t         wt;
+	std::string_view mode;
+	double           construct_ns;
+	size_t           frames;
+	double           ns_per_frame;
+};
+
+double elapsed_ns(bench_clock::time_point s, bench_clock::time_point e)
+{
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(e - s).count());
+}
+
+// keeps the optimiser from discarding the results.
+fp_t volatile sink;
+
+// repeat 'fn', which transforms 'per' frames, until at least 'min_ns' has passed.
+template<typename F> std::pair<size_t, double> run_for(F fn, size_t per, double min_ns)
+{
+	size_t frames = 0;
+	auto s = bench_clock::now();
+	auto e = s;
+	do
+	{
+		fn();
+		frames += per;
+		e = bench_clock::now();
+	} while (elapsed_ns(s, e) < min_ns || frames < 3 * per);
+	return { frames, elapsed_ns(s, e) / frames };
+}
+
+void write_csv_header()
+{
+	std::cout << "width,size,window,mode,construct_ns,frames,ns_per_frame,ns_per_point,gflops,bytes_per_s\n";
+}
+
+void write_csv(result_t const& r)
+{
+	double const n = static_cast<double>(size_t(1) << r.width);
+	std::cout << r.width << ','
+		<< (size_t(1) << r.width) << ','
+		<< wt_to_string(r.wt) << ','
+		<< r.mode << ','
+		<< r.construct_ns << ','
+		<< r.frames << ','
+		<< r.ns_per_frame << ','
+		<< r.ns_per_frame / n << ','
+		<< 5.0 * n * r.width / r.ns_per_frame << ','
+		<< n * sizeof(fp_t) * 1e9 / r.ns_per_frame << '\n';
+}
+
+void write_json(result_t const& r, bool first)
+{
+	double const n = static_cast<double>(size_t(1) << r.width);
+	std::cout << (first ? "  " : ",\n  ")
+		<< "{\"width\": " << r.width
+		<< ", \"size\": " << (size_t(1) << r.width)
+		<< ", \"window\": \"" << wt_to_string(r.wt) << '"'
+		<< ", \"mode\": \"" << r.mode << '"'
+		<< ", \"construct_ns\": " << r.construct_ns
+		<< ", \"frames\": " << r.frames
+		<< ", \"ns_per_frame\": " << r.ns_per_frame
+		<< ", \"ns_per_point\": " << r.ns_per_frame / n
+		<< ", \"gflops\": " << 5.0 * n * r.width / r.ns_per_frame
+		<< ", \"bytes_per_s\": " << n * sizeof(fp_t) * 1e9 / r.ns_per_frame
+		<< '}';
+}
+
+int main(int argc, char* argv[])
+{
+	size_t lo = FFTWdMin;
+	size_t hi = FFTWdMax;
+	int    wcode = -1;
+	size_t batch = 8;
+	double min_ns = 200e6;
+	bool   bJSON = false;
+
+	int		arg = 1;
+	while (arg < argc)
+	{
+		if (argv[arg][0] == '-' || argv[arg][0] == '/')
+		{
+			switch (argv[arg][1])
+			{
+			case 'L':
+			case 'l':
+				lo = atoi(argv[arg] + 2);
+				break;
+			case 'H':
+			case 'h':
+				hi = atoi(argv[arg] + 2);
+				break;
+			case 'W':
+			case 'w':
+				wcode = argv[arg][2];
+				break;
+			case 'B':
+			case 'b':
+				batch = atoi(argv[arg] + 2);
+				break;
+			case 'T':
+			case 't':
+				min_ns = atof(argv[arg] + 2) * 1e6;
+				break;
+			case 'J':
+			case 'j':
+				bJSON = true;
+				break;
+			default:
+				std::cerr << "Unknown argument \'" << argv[arg][1] << "\'!\n";
+				Usage();
+				return -1;
+			}
+		}
+		else
+		{
+			Usage();
+			return -1;
+		}
+		++arg;
+	}
+	if (lo < FFTWdMin || hi > FFTWdMax || lo > hi || batch == 0)
+	{
+		std::cerr << "Widths must be between " << FFTWdMin << " and " << FFTWdMax << " inclusive, and batch at least 1.\n";
+		Usage();
+		return -1;
+	}
+
+	// every window_t, by the codes fftit uses.
+	std::vector<window_t> windows;
+	for (char c = '0'; c <= '5'; ++c)
+		if (wcode == -1 || wcode == c)
+			windows.push_back(wt_from_code(c));
+
+	if (bJSON)
+		std::cout << "[\n";
+	else
+		write_csv_header();
+	bool first = true;
+	auto emit = [&](result_t const& r)
+	{
+		if (bJSON)
+			write_json(r, first);
+		else
+			write_csv(r);
+		first = false;
+		std::cout.flush();
+	};
+
+	for (size_t width = lo; width <= hi; ++width)
+	{
+		size_t const N = size_t(1) << width;
+		// enough signal for 'batch' frames at 50% overlap, as fftit averages.
+		std::vector<fp_t> signal((batch + 1) * N / 2);
+		fill_buffer_with_sine(fp_t(1000), signal.data(), signal.data() + signal.size(), 48000);
+
+		for (auto wt : windows)
+		{
+			std::cerr << "width " << width << ", " << wt_to_string(wt) << "\n";
+
+			// construction, best of a few, it is dominated by table generation.
+			double construct_ns = 0;
+			std::unique_ptr<IProcessorFFT> pfft;
+			for (int n = 0; n < 3; ++n)
+			{
+				pfft.reset();
+				auto s = bench_clock::now();
+				pfft = make_fft(width, wt);
+				auto e = bench_clock::now();
+				construct_ns = n == 0 ? elapsed_ns(s, e) : std::min(construct_ns, elapsed_ns(s, e));
+			}
+
+			// single frame latency, the same frame repeatedly.
+			auto [sf, sns] = run_for([&]()
+				{
+					auto [ob, oe] = (*pfft) (signal.data(), signal.data() + N);
+					sink = *ob;
+				}, 1, min_ns);
+			emit({ width, wt, "single", construct_ns, sf, sns });
+
+			// batched, successive overlapping frames through the signal.
+			auto [bf, bns] = run_for([&]()
+				{
+					for (size_t b = 0; b < batch; ++b)
+					{
+						auto [ob, oe] = (*pfft) (signal.data() + b * N / 2, signal.data() + b * N / 2 + N);
+						sink = *ob;
+					}
+				}, batch, min_ns);
+			emit({ width, wt, "batch", construct_ns, bf, bns });
+		}
+	}
+	if (bJSON)
+		std::cout << "\n]\n";
+
+	return 0;
+}
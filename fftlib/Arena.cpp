@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined (_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "fftlib.h"
+
+#include "Arena.h"
+
+namespace
+{
+	struct arena_t
+	{
+		std::mutex mtx;
+		huge_pages_t hp = huge_pages_t::TRANSPARENT;
+		size_t pool_limit = size_t(256) << 20;
+		// freed blocks by their rounded size.
+		std::map<size_t, std::vector<void*>> pool;
+		arena_stats_t stats{};
+	};
+
+	arena_t& arena()
+	{
+		// never destroyed, blocks may be freed during static destruction.
+		static arena_t& a = *new arena_t;
+		return a;
+	}
+
+	size_t rounded(size_t bytes)
+	{
+		size_t const to = bytes < ArenaHugeMin ? ArenaAlign : ArenaHugeMin;
+		return (std::max<size_t>(bytes, 1) + to - 1) / to * to;
+	}
+
+	// whole huge pages, aligned so all of the block can be backed by them.
+	void* map_block(size_t bytes, huge_pages_t hp, arena_stats_t& st)
+	{
+#if defined (_WIN32)
+		// large pages need a privilege few processes have, so hp is only advice here.
+		(void)hp;
+		(void)st;
+		return ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		if (hp == huge_pages_t::HUGETLB)
+		{
+			int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined (MAP_HUGE_1GB)
+			if (bytes % (size_t(1) << 30) == 0)
+				flags |= MAP_HUGE_1GB;
+#endif
+			void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+			if (p != MAP_FAILED)
+			{
+				++st.hugetlb_blocks;
+				return p;
+			}
+			// none reserved, or not enough, so as TRANSPARENT.
+		}
+		size_t const span = bytes + ArenaHugeMin;
+		char* const p = static_cast<char*>(::mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+		if (p == MAP_FAILED)
+			return nullptr;
+		char* const a = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + ArenaHugeMin - 1) & ~uintptr_t(ArenaHugeMin - 1));
+		if (a != p)
+			::munmap(p, a - p);
+		if (a + bytes != p + span)
+			::munmap(a + bytes, p + span - (a + bytes));
+#if defined (MADV_HUGEPAGE)
+		if (hp != huge_pages_t::NONE)
+			::madvise(a, bytes, MADV_HUGEPAGE);
+#endif
+		return a;
+#endif
+	}
+
+	void unmap_block(void* p, size_t bytes)
+	{
+#if defined (_WIN32)
+		(void)bytes;
+		::VirtualFree(p, 0, MEM_RELEASE);
+#else
+		::munmap(p, bytes);
+#endif
+	}
+
+	void release(void* p, size_t bytes)
+	{
+		if (bytes < ArenaHugeMin)
+			::operator delete(p, std::align_val_t(ArenaAlign));
+		else
+			unmap_block(p, bytes);
+	}
+
+	// the pool down to 'limit', the largest blocks first. Under the lock.
+	void trim(arena_t& a, size_t limit)
+	{
+		for (auto it = a.pool.rbegin(); it != a.pool.rend() && a.stats.pooled_bytes > limit; ++it)
+		{
+			while (!it->second.empty() && a.stats.pooled_bytes > limit)
+			{
+				release(it->second.back(), it->first);
+				it->second.pop_back();
+				a.stats.pooled_bytes -= it->first;
+			}
+		}
+	}
+}
+
+void* arena_allocate(size_t bytes)
+{
+	size_t const sz = rounded(bytes);
+	auto& a = arena();
+	huge_pages_t hp;
+	{
+		std::lock_guard<std::mutex> l(a.mtx);
+		a.stats.allocated_bytes += sz;
+		auto it = a.pool.find(sz);
+		if (it != a.pool.end() && !it->second.empty())
+		{
+			void* p = it->second.back();
+			it->second.pop_back();
+			a.stats.pooled_bytes -= sz;
+			++a.stats.reused;
+			return p;
+		}
+		++a.stats.fresh;
+		hp = a.hp;
+	}
+	if (sz < ArenaHugeMin)
+		return ::operator new(sz, std::align_val_t(ArenaAlign));
+	arena_stats_t st{};
+	void* p = map_block(sz, hp, st);
+	std::lock_guard<std::mutex> l(a.mtx);
+	a.stats.hugetlb_blocks += st.hugetlb_blocks;
+	if (!p)
+	{
+		a.stats.allocated_bytes -= sz;
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void arena_deallocate(void* p, size_t bytes)
+{
+	if (!p)
+		return;
+	size_t const sz = rounded(bytes);
+	auto& a = arena();
+	{
+		std::lock_guard<std::mutex> l(a.mtx);
+		a.stats.allocated_bytes -= sz;
+		if (a.stats.pooled_bytes + sz <= a.pool_limit)
+		{
+			a.pool[sz].push_back(p);
+			a.stats.pooled_bytes += sz;
+			return;
+		}
+	}
+	release(p, sz);
+}
+
+void configure_arena(huge_pages_t hp, size_t pool_bytes)
+{
+	auto& a = arena();
+	std::lock_guard<std::mutex> l(a.mtx);
+	a.hp = hp;
+	a.pool_limit = pool_bytes;
+	trim(a, pool_bytes);
+}
+
+arena_stats_t arena_stats()
+{
+	auto& a = arena();
+	std::lock_guard<std::mutex> l(a.mtx);
+	return a.stats;
+}
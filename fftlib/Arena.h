@@ -0,0 +1,48 @@
+//
+//	Arena.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// where processors, their workspaces and the shared tables live. Every block
+// is ArenaAlign aligned, blocks of ArenaHugeMin and more are mapped on their
+// own, whole huge pages, and freed blocks are pooled by size for the next
+// processor of the same width. configure_arena and arena_stats in fftlib.h.
+//
+const size_t ArenaAlign   = 64 ;
+const size_t ArenaHugeMin = size_t ( 2 ) << 20 ;
+
+void* arena_allocate ( size_t bytes ) ;
+void  arena_deallocate ( void* p, size_t bytes ) ;
+
+// a base whose derived classes are allocated from the arena. The sizes are
+// the dynamic type's, a virtual destructor sees to that.
+//
+struct arena_object
+{
+	static void* operator new ( size_t bytes ) { return arena_allocate ( bytes ) ; }
+	static void* operator new ( size_t bytes, std::align_val_t ) { return arena_allocate ( bytes ) ; }
+	static void  operator delete ( void* p, size_t bytes ) { arena_deallocate ( p, bytes ) ; }
+	static void  operator delete ( void* p, size_t bytes, std::align_val_t ) { arena_deallocate ( p, bytes ) ; }
+} ;
+
+// for containers and allocate_shared, no more alignment than ArenaAlign.
+//
+template <typename T> struct arena_allocator
+{
+	using value_type = T ;
+	static_assert(alignof(T) <= ArenaAlign, "arena blocks are only ArenaAlign aligned.");
+
+	arena_allocator () = default ;
+	template <typename U> arena_allocator ( arena_allocator<U> const& ) {}
+	T* allocate ( size_t n ) { return static_cast<T*>( arena_allocate ( n * sizeof ( T ))) ; }
+	void deallocate ( T* p, size_t n ) { arena_deallocate ( p, n * sizeof ( T )) ; }
+	template <typename U> bool operator == ( arena_allocator<U> const& ) const { return true ; }
+} ;
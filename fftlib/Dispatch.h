@@ -0,0 +1,57 @@
+//
+//	Dispatch.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <type_traits>
+
+// from a run time width to a compile time FFTSZ. Calls fn with
+// std::integral_constant<size_t, 2^width> and returns what it returns,
+// or R{} if width is outside FFTWdMin to FFTWdMax.
+//
+template <typename R, typename F> R dispatch_width ( size_t width, F fn )
+{
+	switch ( width )
+	{
+	case  8:
+		return fn ( std::integral_constant<size_t, 256> {} ) ;
+	case  9:
+		return fn ( std::integral_constant<size_t, 512> {} ) ;
+	case 10:
+		return fn ( std::integral_constant<size_t, 1024> {} ) ;
+	case 11:
+		return fn ( std::integral_constant<size_t, 2048> {} ) ;
+	case 12:
+		return fn ( std::integral_constant<size_t, 4096> {} ) ;
+	case 13:
+		return fn ( std::integral_constant<size_t, 8192> {} ) ;
+	case 14:
+		return fn ( std::integral_constant<size_t, 16384> {} ) ;
+	case 15:
+		return fn ( std::integral_constant<size_t, 32768> {} ) ;
+	case 16:
+		return fn ( std::integral_constant<size_t, 65536> {} ) ;
+	case 17:
+		return fn ( std::integral_constant<size_t, 131072> {} ) ;
+	case 18:
+		return fn ( std::integral_constant<size_t, 262144> {} ) ;
+	case 19:
+		return fn ( std::integral_constant<size_t, 524288> {} ) ;
+	case 20:
+		return fn ( std::integral_constant<size_t, 1048576> {} ) ;
+	case 21:
+		return fn ( std::integral_constant<size_t, 2097152> {} ) ;
+	case 22:
+		return fn ( std::integral_constant<size_t, 4194304> {} ) ;
+	case 23:
+		return fn ( std::integral_constant<size_t, 8388608> {} ) ;
+	case 24:
+		return fn ( std::integral_constant<size_t, 16777216> {} ) ;
+	}
+	return R {} ;
+}
@@ -6,33 +6,112 @@
 
 #pragma once
 
+#include <vector>
+
+#include "SharedTable.h"
+
+// an input sample's value, integer PCM as its integer, and the scale that
+// brings integer full scale to 1.0. The scale is applied to the results,
+// not to each sample, since everything between is linear.
+//
+template <typename T, typename S> T sample_value ( S s ) { return static_cast<T>( s ) ; }
+template <typename T> T sample_value ( pcm24_t s ) { return static_cast<T>( static_cast<int32_t>( s )) ; }
+
+template <typename S> inline constexpr double sample_scale_v = 1.0 ;
+template <> inline constexpr double sample_scale_v<int16_t> = 1.0 / 32768.0 ;
+template <> inline constexpr double sample_scale_v<pcm24_t> = 1.0 / 8388608.0 ;
+template <> inline constexpr double sample_scale_v<int32_t> = 1.0 / 2147483648.0 ;
+
 template <typename T, size_t FFTSZ > class Window
 {
 private :
-	// coeffs.
-	std::array<T, FFTSZ> coeff_table_;
+	// coeffs, shared by every Window of this size and type.
+	struct table_t
+	{
+		alignas ( ArenaAlign ) std::array<T, FFTSZ> coeff_ ;
+		T gain_ ;
+	} ;
+	std::shared_ptr<table_t const> table_ ;
+	T const* coeff_ ;
 	T gain_ ;
+	window_t wt_ ;
+
+	static void Fill ( window_t wt, table_t& t ) ;
+	template <typename F> static void FillSymmetric ( table_t& t, F fn ) ;
+	template <typename F> static void FillCosine ( table_t& t, F fn ) ;
 public :
 	Window (window_t wt = window_t::HAMMING) ;
 	template<typename II, typename OI> void operator () ( II samples_b, II samples_e, OI out_b) const ;
 	T Gain () const ;
+	T operator [] ( size_t n ) const { return coeff_[n] ; }
+	window_t Type () const { return wt_ ; }
+} ;
+
+// how FFT::operator() orders the butterflies of each radix-2 stage.
+// stages whose half span 'k' is at least 'split' run each twiddle over a
+// contiguous block, the remainder run the original strided order.
+// split == FFTSZ (or more) is the original kernel throughout.
+//
+struct fft_strategy_t
+{
+	size_t split ;
 } ;
 
-template < typename T, size_t FFTSZ, int Invert = 1> class FFT
+// T is the data's type, C the twiddles' and the butterflies' arithmetic's.
+// C != T runs the stages in pairs, each pair's results rounded to T once,
+// so the data is converted half as often. It has no codelets.
+//
+template < typename T, size_t FFTSZ, int Invert = 1, typename C = T> class FFT
 {
 private :
 	// 'static'
 //	int lgN_ ;
 	const T   div_ ;
-	std::array<std::complex<T>, FFTSZ / 2>  w_ ;
+	// the twiddles, compile time for the smaller sizes, otherwise shared by
+	// every FFT of this size and direction.
+	struct alignas ( ArenaAlign ) twiddles_t : std::array<std::complex<C>, FFTSZ / 2> {} ;
+	std::shared_ptr<twiddles_t const> wtable_ ;
+	std::complex<C> const* w_ ;
+	fft_strategy_t strategy_ ;
+
+	// working variables, only sized when a transform without scratch needs them.
+	std::vector<std::complex<T>, arena_allocator<std::complex<T>>>  buf_ ;
 
-	// working variables.
-	std::array<std::complex<T>, FFTSZ>  buf_ ;
+	std::complex<T> * Buffer () ;
+	void StageStrided ( size_t k, std::complex<T> const* from, std::complex<T> * to ) const ;
+	void StageBlocked ( size_t k, std::complex<T> const* from, std::complex<T> * to ) const ;
+	void StagePair ( size_t k, std::complex<T> const* from, std::complex<T> * to ) const ;
+	void Codelets ( std::complex<T> const * in, std::complex<T> * out, std::complex<T> * scratch ) const ;
+	void StagePruned ( size_t k, std::complex<T> const* from, std::complex<T> * to, size_t first, size_t count, size_t live ) const ;
 
 public :
 	FFT () ;
-	void operator () ( std::complex<T> * in, std::complex<T> * out ) ;
+	void operator () ( std::complex<T> const * in, std::complex<T> * out ) ;
+	// pruned. Reads only in[0, live), the rest is taken as zero, and writes only
+	// out[first, first + count) (modulo FFTSZ), the rest of 'out' is left undefined.
+	void operator () ( std::complex<T> const * in, std::complex<T> * out, size_t live, size_t first, size_t count ) ;
+	// reentrant, as above but working in 'scratch', FFTSZ points of the caller's, rather than
+	// the FFT's own. Any number of threads may use one FFT this way, each with its own scratch.
+	void operator () ( std::complex<T> const * in, std::complex<T> * out, std::complex<T> * scratch ) const ;
+	void operator () ( std::complex<T> const * in, std::complex<T> * out, size_t live, size_t first, size_t count, std::complex<T> * scratch ) const ;
+	void Strategy ( fft_strategy_t st ) ;
+	fft_strategy_t Strategy () const ;
+	// a full transform of this size runs the codelets, which don't read the strategy.
+	static constexpr bool HasCodelets () ;
 } ;
 
+// the spectra of two real sequences x and y at bin k, from z, the spectrum of x + iy.
+// X[k] = ( Z[k] + Z*[N-k] ) / 2 and Y[k] = ( Z[k] - Z*[N-k] ) / 2i.
+//
+template <typename T, size_t FFTSZ> std::pair<std::complex<T>, std::complex<T>> split_pair ( std::complex<T> const* z, size_t k )
+{
+	auto const zk = z[k] ;
+	auto const zc = std::conj ( z[( FFTSZ - k ) & ( FFTSZ - 1 )] ) ;
+	return { ( zk + zc ) * T ( 0.5 ), ( zk - zc ) * std::complex<T> ( 0, T ( -0.5 )) } ;
+}
+
+// the strategy used when there is no wisdom for a size.
+fft_strategy_t fft_strategy_default ( size_t fftsz ) ;
+
 // implementation
 #include "FFTImpl.h"
\ No newline at end of file
@@ -0,0 +1,46 @@
+//
+//	FFTCore.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include "FFT.h"
+
+// a complex FFT whose size is chosen at run time, for the processors
+// that are built from transforms rather than being one.
+//
+template <typename T> struct IFFTCore
+{
+	virtual ~IFFTCore () {} ;
+	virtual void operator () ( std::complex<T> const* in, std::complex<T> * out ) = 0 ;
+	virtual size_t size () const = 0 ;
+} ;
+
+template <typename T, size_t FFTSZ, int Invert> class FFTCore : public IFFTCore<T>
+{
+private :
+	FFT<T, FFTSZ, Invert> fft_ ;
+
+public :
+	FFTCore ( fft_strategy_t st )
+	{
+		fft_.Strategy ( st ) ;
+	}
+	virtual void operator () ( std::complex<T> const* in, std::complex<T> * out ) final
+	{
+		fft_ ( in, out ) ;
+	}
+	virtual size_t size () const final
+	{
+		return FFTSZ ;
+	}
+} ;
+
+// width as make_fft, Invert 1 forward, -1 inverse (and scaled by 1/FFTSZ).
+// uses the wisdom for the width if there is any. Empty if the width is out of range.
+//
+std::unique_ptr<IFFTCore<fp_t>> make_fft_core ( size_t width, int invert ) ;
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "FFT.h"
+
+// Q15, [-1, 1) as [-32768, 32767].
+using fixed_t = int16_t ;
+
+// a radix-2 Stockham FFT in 16 bit block floating point. Complex data is planar,
+// all the real parts and then all the imaginary, so the butterflies
+// are plain 16 bit lanes with 32 bit products. Each stage's largest input part,
+// found as the previous stage wrote it, decides a shift of 0, 1 or 2 bits, just
+// enough that the stage can't overflow, and the shifts are summed into the block
+// exponent returned.
+// Each stage rounds its shifts to nearest, and its products down in pairs whose
+// errors cancel, so the error per stage is about an LSB wherever the block is,
+// and a block kept near full scale keeps its SNR; see precision_t::FIXED for the bound.
+//
+template <size_t FFTSZ> class FFTFixed
+{
+private :
+	// the Q15 twiddles, planar, shared by every FFTFixed of this size. Then each repeated
+	// twice and four times over, as the stages with those spans read them.
+	struct table_t
+	{
+		alignas ( ArenaAlign ) std::array<fixed_t, FFTSZ / 2> wr_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, FFTSZ / 2> wi_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, FFTSZ / 2> wr2_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, FFTSZ / 2> wi2_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, FFTSZ / 2> wr4_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, FFTSZ / 2> wi4_ ;
+	} ;
+	std::shared_ptr<table_t const> table_ ;
+
+	static void Fill ( table_t& t ) ;
+	static fixed_t Peak ( fixed_t const* in ) ;
+	// each returns the peak of what it wrote.
+	template <int Shift> fixed_t Stage ( size_t k, fixed_t const* from, fixed_t* to ) const ;
+	template <size_t K, int Shift> fixed_t StageSmall ( fixed_t const* from, fixed_t* to ) const ;
+	template <int Shift> fixed_t StageBlocked ( size_t k, fixed_t const* from, fixed_t* to ) const ;
+
+public :
+	FFTFixed () ;
+	// reentrant. Transforms FFTSZ points from 'in' to 'out', working in 'scratch', each 2 * FFTSZ,
+	// the real parts then the imaginary. The spectrum is 'out' times 2^exponent returned.
+	int operator () ( fixed_t const* in, fixed_t* out, fixed_t* scratch ) const ;
+} ;
+
+// implementation
+#include "FFTFixedImpl.h"
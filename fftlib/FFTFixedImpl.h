@@ -0,0 +1,177 @@
+//
+//	FFTFixedImpl.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+// a stage's outputs are at most ( 1 + sqrt 2 ) times its largest input part, plus rounding. Blocks
+// below FixedNoShift can't overflow unshifted, below FixedOneShift shifted one, and any shifted two.
+const int FixedNoShift  = 13500 ;
+const int FixedOneShift = 27000 ;
+
+template <size_t FFTSZ>
+void FFTFixed<FFTSZ>::Fill ( table_t& t )
+{
+	auto q15 = [] ( double v ) { return static_cast<fixed_t>( std::clamp ( std::lround ( v * 32768.0 ), -32767L, 32767L )) ; } ;
+	parallel_for ( FFTSZ / 2, TableGrain, [ & ] ( size_t b, size_t e )
+		{
+			for_each_angle ( b, e, 2 * std::numbers::pi / static_cast<double>( FFTSZ ), [ & ] ( size_t k, double c, double s )
+				{
+					t.wr_[k] = q15 ( c ) ;
+					t.wi_[k] = q15 ( -s ) ;
+				}) ;
+		}) ;
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+	{
+		t.wr2_[k] = t.wr_[k & ~size_t ( 1 )] ;
+		t.wi2_[k] = t.wi_[k & ~size_t ( 1 )] ;
+		t.wr4_[k] = t.wr_[k & ~size_t ( 3 )] ;
+		t.wi4_[k] = t.wi_[k & ~size_t ( 3 )] ;
+	}
+}
+
+template <size_t FFTSZ>
+FFTFixed<FFTSZ>::FFTFixed ()
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+	table_ = shared_table<table_t, int>::get ( 0, [] ( table_t& t ) { Fill ( t ) ; }) ;
+}
+
+// the largest part, as x ^ ( x >> 15 ), which is |x| for x >= 0 and |x| - 1 otherwise and stays in 16 bits.
+inline fixed_t fixed_peak ( fixed_t x )
+{
+	return static_cast<fixed_t>( x ^ ( x >> 15 )) ;
+}
+
+template <size_t FFTSZ>
+fixed_t FFTFixed<FFTSZ>::Peak ( fixed_t const* in )
+{
+	fixed_t m = 0 ;
+	for ( size_t n = 0; n < 2 * FFTSZ; ++n )
+		m = std::max ( m, fixed_peak ( in[n] )) ;
+	return m ;
+}
+
+// the bits to shift a stage by, given the peak of its input.
+inline int fixed_shift ( fixed_t peak )
+{
+	return peak < FixedNoShift ? 0 : peak < FixedOneShift ? 1 : 2 ;
+}
+
+// how a stage shifts its butterflies' inputs, rounding to nearest. a by the stage's shift, and b by
+// one less since it's then multiplied by the twiddle with the product's high half, a further halving.
+// A constant so that each shift is its own loop, with nothing to round when it's 0.
+template <int Shift> fixed_t fixed_scale_a ( fixed_t x )
+{
+	if constexpr ( Shift == 0 )
+		return x ;
+	else
+		return static_cast<fixed_t>(( x >> Shift ) + (( x >> ( Shift - 1 )) & 1 )) ;
+}
+
+template <int Shift> fixed_t fixed_scale_b ( fixed_t x )
+{
+	if constexpr ( Shift == 0 )
+		return static_cast<fixed_t>( x * 2 ) ;
+	else
+		return fixed_scale_a<Shift - 1> ( x ) ;
+}
+
+// the high half of x w, w Q15, a single multiply for most vector units. It rounds down, so both
+// parts of w b are taken as differences of two, whose errors then cancel on average.
+inline fixed_t fixed_mulhi ( fixed_t x, fixed_t w )
+{
+	return static_cast<fixed_t>(( int32_t ( x ) * w ) >> 16 ) ;
+}
+
+// a butterfly, t1 = a + w b and t2 = a - w b, every step within 16 bits. The outputs' peak is kept
+// for the next stage.
+template <int Shift> void fixed_butterfly ( fixed_t ar, fixed_t ai, fixed_t br, fixed_t bi, fixed_t wr, fixed_t wi,
+	fixed_t& t1r, fixed_t& t1i, fixed_t& t2r, fixed_t& t2i, fixed_t& peak )
+{
+	ar = fixed_scale_a<Shift> ( ar ) ;
+	ai = fixed_scale_a<Shift> ( ai ) ;
+	br = fixed_scale_b<Shift> ( br ) ;
+	bi = fixed_scale_b<Shift> ( bi ) ;
+	fixed_t const xr = static_cast<fixed_t>( fixed_mulhi ( br, wr ) - fixed_mulhi ( bi, wi )) ;
+	fixed_t const xi = static_cast<fixed_t>( fixed_mulhi ( bi, wr ) - fixed_mulhi ( br, static_cast<fixed_t>( -wi ))) ;
+	t1r = static_cast<fixed_t>( ar + xr ) ;
+	t1i = static_cast<fixed_t>( ai + xi ) ;
+	t2r = static_cast<fixed_t>( ar - xr ) ;
+	t2i = static_cast<fixed_t>( ai - xi ) ;
+	peak = std::max ( peak, std::max ( std::max ( fixed_peak ( t1r ), fixed_peak ( t1i )), std::max ( fixed_peak ( t2r ), fixed_peak ( t2i )))) ;
+}
+
+// the butterflies of StageBlocked for a span too short to vectorise alone. With K known each
+// iteration reads 2 * K contiguous parts and writes K, groups the compiler can vectorise across,
+// and the twiddles, repeated K times, are read contiguously too.
+template <size_t FFTSZ>
+template <size_t K, int Shift> fixed_t FFTFixed<FFTSZ>::StageSmall ( fixed_t const* from, fixed_t* to ) const
+{
+	fixed_t peak = 0 ;
+	fixed_t const* wr = K == 1 ? table_->wr_.data () : K == 2 ? table_->wr2_.data () : table_->wr4_.data () ;
+	fixed_t const* wi = K == 1 ? table_->wi_.data () : K == 2 ? table_->wi2_.data () : table_->wi4_.data () ;
+	for ( size_t j = 0; j < FFTSZ / 2; j += K )
+		for ( size_t s = 0; s < K; ++s )
+			fixed_butterfly<Shift> ( from[2 * j + s], from[FFTSZ + 2 * j + s], from[2 * j + K + s], from[FFTSZ + 2 * j + K + s], wr[j + s], wi[j + s],
+				to[j + s], to[FFTSZ + j + s], to[FFTSZ / 2 + j + s], to[FFTSZ + FFTSZ / 2 + j + s], peak ) ;
+	return peak ;
+}
+
+template <size_t FFTSZ>
+template <int Shift> fixed_t FFTFixed<FFTSZ>::StageBlocked ( size_t k, fixed_t const* from, fixed_t* to ) const
+{
+	fixed_t peak = 0 ;
+	for ( size_t j = 0; j < FFTSZ / 2; j += k )
+	{
+		fixed_t const wr = table_->wr_[j] ;
+		fixed_t const wi = table_->wi_[j] ;
+		fixed_t const* f1 = from + 2 * j ;
+		fixed_t const* f2 = f1 + k ;
+		fixed_t* t1 = to + j ;
+		fixed_t* t2 = t1 + FFTSZ / 2 ;
+		for ( size_t s = 0; s < k; ++s )
+			fixed_butterfly<Shift> ( f1[s], f1[FFTSZ + s], f2[s], f2[FFTSZ + s], wr, wi, t1[s], t1[FFTSZ + s], t2[s], t2[FFTSZ + s], peak ) ;
+	}
+	return peak ;
+}
+
+template <size_t FFTSZ>
+template <int Shift> fixed_t FFTFixed<FFTSZ>::Stage ( size_t k, fixed_t const* from, fixed_t* to ) const
+{
+	switch ( k )
+	{
+	case 1 :
+		return StageSmall<1, Shift> ( from, to ) ;
+	case 2 :
+		return StageSmall<2, Shift> ( from, to ) ;
+	case 4 :
+		return StageSmall<4, Shift> ( from, to ) ;
+	default :
+		return StageBlocked<Shift> ( k, from, to ) ;
+	}
+}
+
+template <size_t FFTSZ>
+int FFTFixed<FFTSZ>::operator () ( fixed_t const* in, fixed_t* out, fixed_t* scratch ) const
+{
+	// the stages alternate between 'out' and 'scratch', starting so that the last lands in 'out'.
+	bool to_out = ( std::bit_width ( FFTSZ ) - 1 ) % 2 == 1 ;
+	fixed_t const* from = in ;
+	int exponent = 0 ;
+	fixed_t peak = Peak ( in ) ;
+	for ( size_t k = FFTSZ / 2; k > 0; k /= 2 )
+	{
+		fixed_t* to = to_out ? out : scratch ;
+		int const shift = fixed_shift ( peak ) ;
+		peak = shift == 0 ? Stage<0> ( k, from, to ) : shift == 1 ? Stage<1> ( k, from, to ) : Stage<2> ( k, from, to ) ;
+		exponent += shift ;
+		from = to ;
+		to_out = !to_out ;
+	}
+	return exponent ;
+}
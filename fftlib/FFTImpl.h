@@ -8,120 +8,200 @@
 
 #pragma once
 
-// helpers to apply a Hamming window to a range of data.
-// usually associated with FFT...
+#include "Parallel.h"
+
+// tables bigger than this are generated on several threads.
+const size_t TableGrain = 32768 ;
+
+// calls fn ( n, cos ( n * step ), sin ( n * step )) for n in [b, e).
+// The angle is advanced by rotation and evaluated directly afresh every
+// RecurrenceSpan steps, so the recurrence error stays at a few double ulps
+// while the library trig functions are called only once per span.
 //
-template <typename T, size_t FFTSZ> class HamFn
+const size_t RecurrenceSpan = 64 ;
+
+template <typename F> void for_each_angle ( size_t b, size_t e, double step, F fn )
 {
-private :
-	size_t ind_ ;
-public :
-	HamFn () : ind_ ( 0 )
+	double const dc = std::cos ( step ) ;
+	double const ds = std::sin ( step ) ;
+	for ( size_t n0 = b; n0 < e; n0 += RecurrenceSpan )
 	{
+		double c = std::cos ( static_cast<double>( n0 ) * step ) ;
+		double s = std::sin ( static_cast<double>( n0 ) * step ) ;
+		size_t const n1 = std::min ( e, n0 + RecurrenceSpan ) ;
+		for ( size_t n = n0; n < n1; ++n )
+		{
+			fn ( n, c, s ) ;
+			double const t = c * dc - s * ds ;
+			s = s * dc + c * ds ;
+			c = t ;
+		}
 	}
-	T operator () ()
+}
+
+// the window functions. All of them are symmetric about the centre of the window.
+// The cosine sums are evaluated from cx = cos ( 2 * pi * ind / ( FFTSZ - 1 )),
+// the higher harmonics by the multiple angle formulae.
+//
+// Hamming.
+// usually associated with FFT...
+//
+template <typename T> class HamFn
+{
+public :
+	T operator () ( double cx ) const
 	{
-		T ret = static_cast<T>( 0.54 ) - static_cast<T>( 0.46 ) * cos ( static_cast<T>( 2 ) * std::numbers::pi * static_cast<T>( ind_ ) / static_cast<T>( FFTSZ - 1 )) ;
-		++ind_ ;
-		return ret ;
+		return static_cast<T>( 0.54 - 0.46 * cx ) ;
 	}
 } ;
 
 // Blackman
-template <typename T, size_t FFTSZ> class BlackmanFn
+template <typename T> class BlackmanFn
 {
-private :
-	size_t ind_ ;
 public :
-	BlackmanFn () : ind_ ( 0 )
-	{
-	}
-	T operator () ()
+	T operator () ( double cx ) const
 	{
-		T ret = static_cast<T>( 7938 ) / static_cast<T>( 18608 )
-			  - static_cast<T>( 9240 ) / static_cast<T>( 18608 ) * cos ( static_cast<T>( 2 ) * std::numbers::pi * static_cast<T>( ind_ ) / static_cast<T>( FFTSZ - 1 ))
-			  + static_cast<T>( 1430 ) / static_cast<T>( 18608 ) * cos ( static_cast<T>( 4 ) * std::numbers::pi * static_cast<T>( ind_ ) / static_cast<T>( FFTSZ - 1 )) ;
-		++ind_ ;
-		return ret ;
+		double const c2x = 2 * cx * cx - 1 ;
+		return static_cast<T>( 7938.0 / 18608.0 - 9240.0 / 18608.0 * cx + 1430.0 / 18608.0 * c2x ) ;
 	}
 } ;
 
 // Blackman-Harris
-template <typename T, size_t FFTSZ> class BlackmanHarrisFn
+template <typename T> class BlackmanHarrisFn
 {
-private :
-	size_t ind_ ;
 public :
-	BlackmanHarrisFn () : ind_ ( 0 )
+	T operator () ( double cx ) const
 	{
+		double const c2x = 2 * cx * cx - 1 ;
+		double const c3x = cx * ( 4 * cx * cx - 3 ) ;
+		return static_cast<T>( 0.35875 - 0.48829 * cx + 0.1365995 * c2x - 0.0106411 * c3x ) ;
 	}
-	T operator () ()
+} ;
+
+// modified Bessel function of the first kind, order 0. The power series,
+// all terms positive so there is no cancellation, and for the arguments a
+// Kaiser window needs (up to order * pi) it converges in a few dozen terms.
+// Much quicker than std::cyl_bessel_i, which is general purpose.
+//
+inline double bessel_i0 ( double x )
+{
+	double const q = x * x / 4 ;
+	double term = 1 ;
+	double sum  = 1 ;
+	for ( int k = 1; term > sum * 1e-17; ++k )
 	{
-		T ret = static_cast<T>( 0.35875 ) - static_cast<T>( 0.48829 ) * cos ( static_cast<T>( 2 ) * std::numbers::pi * static_cast<T>( ind_ ) / static_cast<T>( FFTSZ - 1 ))
-			+ static_cast<T>( 0.1365995 ) * cos ( static_cast<T>( 4 ) * std::numbers::pi * static_cast<T>( ind_ ) / static_cast<T>( FFTSZ - 1 ))
-			- static_cast<T>( 0.0106411 ) * cos ( static_cast<T>( 6 ) * std::numbers::pi * static_cast<T>( ind_ ) / static_cast<T>( FFTSZ - 1 ));
-		++ind_ ;
-		return ret ;
+		term *= q / ( static_cast<double>( k ) * k ) ;
+		sum  += term ;
 	}
-} ;
+	return sum ;
+}
 
 // Kaiser
 //
 template <typename T, size_t FFTSZ, size_t order> class KaiserFn
 {
-private :
-	size_t ind_ ;
-	T      div_ ;
 public :
-	KaiserFn () : ind_ ( 0 )
+	T operator () ( size_t ind ) const
 	{
-		div_ = std::cyl_bessel_i ( 0, static_cast<T>(order) * std::numbers::pi) ;
-	}
-	T operator () ()
-	{
-		T sq  = static_cast<T>(2) * static_cast<T>(ind_) / static_cast<T>(FFTSZ - 1 ) - static_cast<T>( 1 ) ;
+		double sq = 2.0 * static_cast<double>( ind ) / static_cast<double>( FFTSZ - 1 ) - 1.0 ;
 		sq *= sq ;
-		T arg = static_cast<T>(order) * std::numbers::pi * sqrt ( static_cast<T>(1) - sq ) ;
-		T ret = std::cyl_bessel_i ( 0, arg ) ;
-		++ind_ ;
-		return ret ;
+		return static_cast<T>( bessel_i0 ( static_cast<double>( order ) * std::numbers::pi * sqrt ( 1.0 - sq ))) ;
 	}
 } ;
 
-template <typename T, size_t FFTSZ> Window<T, FFTSZ>::Window ( window_t wt )
+// coefficient n of a window 'len' long, for the processors whose windows aren't FFTSZ.
+//
+inline double window_coefficient ( window_t wt, size_t n, size_t len )
+{
+	if ( len < 2 )
+		return 1.0 ;
+	double const cx = std::cos ( 2 * std::numbers::pi * static_cast<double>( n ) / static_cast<double>( len - 1 )) ;
+	double const r  = 2.0 * static_cast<double>( n ) / static_cast<double>( len - 1 ) - 1.0 ;
+	switch ( wt )
+	{
+	default :
+	case window_t::HAMMING :
+		return HamFn<double> () ( cx ) ;
+	case window_t::NOWINDOW :
+		return 1.0 ;
+	case window_t::BLACKMAN :
+		return BlackmanFn<double> () ( cx ) ;
+	case window_t::BLACKMANHARRIS :
+		return BlackmanHarrisFn<double> () ( cx ) ;
+	case window_t::KAISER5 :
+		return bessel_i0 ( 5 * std::numbers::pi * std::sqrt ( std::max ( 0.0, 1.0 - r * r ))) ;
+	case window_t::KAISER7 :
+		return bessel_i0 ( 7 * std::numbers::pi * std::sqrt ( std::max ( 0.0, 1.0 - r * r ))) ;
+	}
+}
+
+template <typename T, size_t FFTSZ> Window<T, FFTSZ>::Window ( window_t wt ) :
+	table_ { shared_table<table_t, window_t>::get ( wt, [ wt ] ( table_t& t ) { Fill ( wt, t ) ; }) },
+	coeff_ { table_->coeff_.data () },
+	gain_ { table_->gain_ },
+	wt_ { wt }
+{
+}
+
+template <typename T, size_t FFTSZ> void Window<T, FFTSZ>::Fill ( window_t wt, table_t& t )
 {
 	// build ham table
 	switch ( wt )
 	{
 	default :
 	case window_t::HAMMING :
-		std::generate ( coeff_table_.begin(), coeff_table_.end(), HamFn<T, FFTSZ>());
+		FillCosine ( t, HamFn<T> ()) ;
 		break ;
 	case window_t::NOWINDOW :
-		std::fill (coeff_table_.begin(), coeff_table_.end(), static_cast<T>( 1 )) ;
+		std::fill (t.coeff_.begin(), t.coeff_.end(), static_cast<T>( 1 )) ;
 		break ;
 	case window_t::BLACKMAN :
-		std::generate (coeff_table_.begin(), coeff_table_.end(), BlackmanFn<T, FFTSZ> ()) ;
+		FillCosine ( t, BlackmanFn<T> ()) ;
 		break ;
 	case window_t::BLACKMANHARRIS :
-		std::generate (coeff_table_.begin(), coeff_table_.end(), BlackmanHarrisFn<T, FFTSZ> ()) ;
+		FillCosine ( t, BlackmanHarrisFn<T> ()) ;
 		break ;
 	case window_t::KAISER5 :
-		std::generate (coeff_table_.begin(), coeff_table_.end(), KaiserFn<T, FFTSZ, 5> ()) ;
+		FillSymmetric ( t, KaiserFn<T, FFTSZ, 5> ()) ;
 		break ;
 	case window_t::KAISER7 :
-		std::generate (coeff_table_.begin(), coeff_table_.end(), KaiserFn<T, FFTSZ, 7> ()) ;
+		FillSymmetric ( t, KaiserFn<T, FFTSZ, 7> ()) ;
 		break ;
 	}
-	// calculate gain.
-	auto t = std::accumulate(coeff_table_.begin(), coeff_table_.end(), T{ 0 });
-	gain_ = T(FFTSZ) / t ;
+	// calculate gain, the halves are the same.
+	auto g = 2 * std::accumulate(t.coeff_.begin(), t.coeff_.begin() + FFTSZ / 2, 0.0);
+	t.gain_ = static_cast<T>( FFTSZ / g ) ;
+}
+
+// evaluate the first half of the window and mirror it into the second.
+//
+template <typename T, size_t FFTSZ>
+template <typename F> void Window<T, FFTSZ>::FillSymmetric ( table_t& t, F fn )
+{
+	parallel_for ( FFTSZ / 2, TableGrain, [ &t, &fn ] ( size_t b, size_t e )
+		{
+			for ( size_t n = b; n < e; ++n )
+				t.coeff_[n] = t.coeff_[FFTSZ - 1 - n] = fn ( n ) ;
+		}) ;
+}
+
+template <typename T, size_t FFTSZ>
+template <typename F> void Window<T, FFTSZ>::FillCosine ( table_t& t, F fn )
+{
+	double const step = 2 * std::numbers::pi / static_cast<double>( FFTSZ - 1 ) ;
+	parallel_for ( FFTSZ / 2, TableGrain, [ &t, &fn, step ] ( size_t b, size_t e )
+		{
+			for_each_angle ( b, e, step, [ &t, &fn ] ( size_t n, double c, double )
+				{
+					t.coeff_[n] = t.coeff_[FFTSZ - 1 - n] = fn ( c ) ;
+				}) ;
+		}) ;
 }
 
 template <typename T, size_t FFTSZ> 
 template<typename II, typename OI> void Window<T, FFTSZ>::operator () (II samples_b, II samples_e, OI out_b) const
 {
-	std::transform ( samples_b, samples_e, coeff_table_.begin(), out_b, std::multiplies<T>());
+	std::transform ( samples_b, samples_e, coeff_, out_b, [] ( auto s, T w ) { return sample_value<T> ( s ) * w ; }) ;
 }
 
 template <typename T, size_t FFTSZ> T Window<T, FFTSZ>::Gain () const
@@ -129,56 +209,231 @@ template <typename T, size_t FFTSZ> T Window<T, FFTSZ>::Gain () const
 	return gain_ ;
 }
 
-template <typename T, size_t FFTSZ, int Invert> class WFn
+// sin and cos of 0 <= x <= pi/4 by Taylor series, good to double precision
+// over that range. For making small tables at compile time.
+//
+constexpr std::pair<double, double> octant_sincos ( double x )
 {
-private :
-	size_t ind_ ;
-public :
-	WFn () : ind_ ( 0 )
+	double const x2 = x * x ;
+	double s = x ;
+	double c = 1 ;
+	double ts = x ;
+	double tc = 1 ;
+	for ( int n = 1; n < 12; ++n )
 	{
-		static_assert(Invert == 1 || Invert == -1, "WFn Invert must be 1 or -1 (-1 to invert)");
+		ts *= -x2 / ( ( 2.0 * n ) * ( 2.0 * n + 1 )) ;
+		tc *= -x2 / ( ( 2.0 * n - 1 ) * ( 2.0 * n )) ;
+		s  += ts ;
+		c  += tc ;
 	}
-	std::complex<T> operator () ()
+	return { s, c } ;
+}
+
+// w[k] = exp(-2*PI*i*Invert*k/N), for k in [0, N/2).
+// each k in the first octant, [0, N/8], gives w[k], w[N/4-k], w[N/4+k] and w[N/2-k].
+//
+template <typename T, size_t FFTSZ, int Invert>
+constexpr void set_twiddle_octant ( std::complex<T> * w, size_t k, double s, double c )
+{
+	static_assert(FFTSZ >= 4, "twiddle symmetry needs FFTSZ of at least 4");
+	T const st = static_cast<T>( s ) ;
+	T const ct = static_cast<T>( c ) ;
+	w[k]             = std::complex<T> (  ct, -Invert * st ) ;
+	w[FFTSZ / 4 - k] = std::complex<T> (  st, -Invert * ct ) ;
+	w[FFTSZ / 4 + k] = std::complex<T> ( -st, -Invert * ct ) ;
+	if ( k > 0 )
+		w[FFTSZ / 2 - k] = std::complex<T> ( -ct, -Invert * st ) ;
+}
+
+// fill_twiddles ( w, 0, FFTSZ / 8 + 1 ) completes the table. Sub-ranges may be done in parallel.
+//
+template <typename T, size_t FFTSZ, int Invert>
+void fill_twiddles ( std::complex<T> * w, size_t b, size_t e )
+{
+	for_each_angle ( b, e, 2 * std::numbers::pi / static_cast<double>( FFTSZ ), [ w ] ( size_t k, double c, double s )
+		{
+			set_twiddle_octant<T, FFTSZ, Invert> ( w, k, s, c ) ;
+		}) ;
+}
+
+template <typename T, size_t FFTSZ, int Invert>
+constexpr std::array<std::complex<T>, FFTSZ / 2> make_twiddles ()
+{
+	std::array<std::complex<T>, FFTSZ / 2> w {} ;
+	for ( size_t k = 0; k <= FFTSZ / 8; ++k )
+	{
+		auto const sc = octant_sincos ( 2.0 * std::numbers::pi * static_cast<double>( k ) / static_cast<double>( FFTSZ )) ;
+		set_twiddle_octant<T, FFTSZ, Invert> ( w.data (), k, sc.first, sc.second ) ;
+	}
+	return w ;
+}
+
+// tables up to this size are built at compile time.
+const size_t TwiddleConstexprMax = 4096 ;
+
+template <typename T, size_t FFTSZ, int Invert>
+inline constexpr std::array<std::complex<T>, FFTSZ / 2> twiddles_v = make_twiddles<T, FFTSZ, Invert> () ;
+
+// unrolled radix-2 decimation in frequency transforms of R points, L at once, held as
+// separate real and imaginary arrays, point major, so re[p * L + l] is point p of transform l.
+// Natural order in and bit reversed order out. Every butterfly is its own instantiation, so
+// the only loop is across the L transforms, which vectorises, and the twiddles are constants,
+// the trivial ones elided.
+//
+template <typename T, size_t R, size_t L, int Invert> struct codelet
+{
+	static constexpr size_t lgR_ = std::bit_width ( R ) - 1 ;
+
+	// where X[k] ends up.
+	static constexpr size_t rev ( size_t k )
 	{
-		// w = exp(-2*PI*i/N), w[k] = w^k
-		// ^^^ ???
-		T x = T( -2.0 * std::numbers::pi) * Invert * ind_ / FFTSZ ;
-		++ind_ ;
-		return std::complex<T> ( cos ( x ), sin ( x )) ;
+		size_t r = 0 ;
+		for ( size_t b = 0; b < lgR_; ++b )
+			r |= (( k >> b ) & 1 ) << ( lgR_ - 1 - b ) ;
+		return r ;
+	}
+
+	// butterfly B of the stage of half span H.
+	template <size_t H, size_t B> static void butterfly ( T * re, T * im )
+	{
+		constexpr size_t i = B % H ;
+		constexpr size_t p = (( B / H ) * 2 * H + i ) * L ;
+		constexpr size_t q = p + H * L ;
+		constexpr size_t m = i * ( R / ( 2 * H )) ;
+		for ( size_t l = 0; l < L; ++l )
+		{
+			T const dr = re[p + l] - re[q + l] ;
+			T const di = im[p + l] - im[q + l] ;
+			re[p + l] += re[q + l] ;
+			im[p + l] += im[q + l] ;
+			if constexpr ( m == 0 )
+			{
+				re[q + l] = dr ;
+				im[q + l] = di ;
+			}
+			else
+			if constexpr ( m * 4 == R )
+			{
+				// w is +/- i.
+				constexpr T wi = twiddles_v<T, R, Invert>[m].imag () ;
+				re[q + l] = -wi * di ;
+				im[q + l] =  wi * dr ;
+			}
+			else
+			{
+				constexpr T wr = twiddles_v<T, R, Invert>[m].real () ;
+				constexpr T wi = twiddles_v<T, R, Invert>[m].imag () ;
+				re[q + l] = dr * wr - di * wi ;
+				im[q + l] = dr * wi + di * wr ;
+			}
+		}
+	}
+	template <size_t H, size_t... B> static void stage ( T * re, T * im, std::index_sequence<B...> )
+	{
+		( butterfly<H, B> ( re, im ), ... ) ;
+	}
+	template <size_t... S> static void stages ( T * re, T * im, std::index_sequence<S...> )
+	{
+		( stage<( R >> ( S + 1 ))> ( re, im, std::make_index_sequence<R / 2> {} ), ... ) ;
+	}
+	static void apply ( T * re, T * im )
+	{
+		stages ( re, im, std::make_index_sequence<lgR_> {} ) ;
 	}
 } ;
 
-template < typename T, size_t FFTSZ, int Invert>
-FFT<T, FFTSZ, Invert>::FFT () : div_ { Invert == 1 ? 1.0 : T{FFTSZ}}
+// sizes made of two codelets, R columns of N / R points then N / R rows of R points,
+// so up to 4096 the codelets are 16, 32 or 64 points. Columns and rows are done a
+// vector's worth at a time.
+const size_t CodeletFFTMin = 256 ;
+const size_t CodeletFFTMax = TwiddleConstexprMax ;
+
+template <size_t FFTSZ> constexpr size_t codelet_rows_v = size_t ( 1 ) << (( std::bit_width ( FFTSZ ) - 1 ) / 2 ) ;
+template <size_t FFTSZ> constexpr size_t codelet_cols_v = FFTSZ / codelet_rows_v<FFTSZ> ;
+template <typename T>   constexpr size_t codelet_lanes_v = 32 / sizeof ( T ) ;
+
+// the twiddles between the two, w[n2 * N1 + k1] = exp(-2*PI*i*Invert*n2*k1/N).
+template <typename T, size_t FFTSZ, int Invert>
+constexpr std::array<std::complex<T>, FFTSZ> make_codelet_twiddles ()
 {
-	static_assert(Invert == 1 || Invert == -1, "WFn Invert must be 1 or -1 (-1 to invert)");
+	constexpr size_t R  = codelet_cols_v<FFTSZ> ;
+	constexpr size_t N1 = codelet_rows_v<FFTSZ> ;
+	std::array<std::complex<T>, FFTSZ> w {} ;
+	for ( size_t n2 = 0; n2 < R; ++n2 )
+		for ( size_t k1 = 0; k1 < N1; ++k1 )
+		{
+			size_t const j = n2 * k1 ;
+			auto const t = twiddles_v<T, FFTSZ, Invert>[j % ( FFTSZ / 2 )] ;
+			w[n2 * N1 + k1] = j < FFTSZ / 2 ? t : std::complex<T> ( -t.real (), -t.imag ()) ;
+		}
+	return w ;
+}
 
-	// compute lgN_. Use compile time magic?
-	size_t n ;
-	size_t lg;
-	for (n = FFTSZ, lg = 0; n > 1; n /= 2, ++lg)
-		;
-	size_t lgn = std::bit_width(FFTSZ) - 1;
+template <typename T, size_t FFTSZ, int Invert>
+inline constexpr std::array<std::complex<T>, FFTSZ> codelet_twiddles_v = make_codelet_twiddles<T, FFTSZ, Invert> () ;
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+constexpr bool FFT<T, FFTSZ, Invert, C>::HasCodelets ()
+{
+	return std::is_same_v<T, C> && FFTSZ >= CodeletFFTMin && FFTSZ <= CodeletFFTMax ;
+}
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+FFT<T, FFTSZ, Invert, C>::FFT () : div_ { Invert == 1 ? 1.0 : T{FFTSZ}}, strategy_ { fft_strategy_default ( FFTSZ ) }
+{
+	static_assert(Invert == 1 || Invert == -1, "FFT Invert must be 1 or -1 (-1 to invert)");
 
 	// compute 'w' (the complex roots of '1'. w[1]*w[1] == 1, w[2]*w[2]*w[2] == 1 etc etc.
-	std::generate_n ( w_.begin(), FFTSZ / 2, WFn<T, FFTSZ, Invert>());
+	if constexpr ( FFTSZ <= TwiddleConstexprMax )
+		w_ = twiddles_v<C, FFTSZ, Invert>.data () ;
+	else
+	{
+		wtable_ = shared_table<twiddles_t, int>::get ( Invert, [] ( twiddles_t& w )
+			{
+				parallel_for ( FFTSZ / 8 + 1, TableGrain, [ &w ] ( size_t b, size_t e ) { fill_twiddles<C, FFTSZ, Invert> ( w.data (), b, e ) ; }) ;
+			}) ;
+		w_ = wtable_->data () ;
+	}
 }
 
-template < typename T, size_t FFTSZ, int Invert>
-void FFT<T, FFTSZ, Invert>::operator () ( std::complex<T> * in, std::complex<T> * out )
+template < typename T, size_t FFTSZ, int Invert, typename C>
+std::complex<T> * FFT<T, FFTSZ, Invert, C>::Buffer ()
 {
-	// set up
+	if ( buf_.empty ())
+		buf_.resize ( FFTSZ ) ;
+	return buf_.data () ;
+}
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::operator () ( std::complex<T> const * in, std::complex<T> * out )
+{
+	( *this ) ( in, out, Buffer ()) ;
+}
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::operator () ( std::complex<T> const * in, std::complex<T> * out, std::complex<T> * scratch ) const
+{
+	if constexpr ( HasCodelets ())
+	{
+		Codelets ( in, out, scratch ) ;
+		return ;
+	}
+
+	// set up, so the last pass writes 'out'.
+	constexpr bool   paired = !std::is_same_v<T, C> ;
+	constexpr size_t lgN    = std::bit_width ( FFTSZ ) - 1 ;
+	constexpr size_t passes = paired ? ( lgN + 1 ) / 2 : lgN ;
 	std::complex<T> * to_ ;
 	std::complex<T> * from_ ;
-	if ( (std::bit_width(FFTSZ) - 1) % 2 == 0)
+	if ( passes % 2 == 0)
 	{
 		from_ = out ;
-		to_   = buf_.data();
+		to_   = scratch ;
 	}
 	else
 	{
 		to_		= out ;
-		from_	= buf_.data();
+		from_	= scratch ;
 	}
 
 	using namespace std::placeholders;
@@ -188,29 +443,294 @@ void FFT<T, FFTSZ, Invert>::operator () ( std::complex<T> * in, std::complex<T>
 	// the actual thing the thing
 	for ( size_t k = FFTSZ / 2; k > 0; k /= 2 )
 	{
-		for ( size_t s = 0; s < k; ++s )
+		if ( paired && k > 1 )
 		{
-			// initialize pointers
-			std::complex<T> * f1, * f2, * t1, * t2, * ww ;
-			std::complex<T> wwf2 ;
-			f1 = &from_[s]; f2 = &from_[s+k];
-			t1 = &to_[s]; t2 = &to_[s+FFTSZ/2];
-			ww = w_.data();
-			// compute <s,k>
-			while ( ww < w_.data() + FFTSZ / 2)
+			StagePair ( k, from_, to_ ) ;
+			k /= 2 ;
+		}
+		else
+		if ( k >= strategy_.split )
+			StageBlocked ( k, from_, to_ ) ;
+		else
+			StageStrided ( k, from_, to_ ) ;
+		std::swap ( from_, to_ ) ;
+	}
+}
+
+// N = N1 * R, X[k1 + N1 * k2] = sum over n2 of W_R^(n2 * k2) * W_N^(n2 * k1) * ( sum over n1
+// of W_N1^(n1 * k1) * x[R * n1 + n2] ). The inner sums are the columns, the outer the rows.
+// The columns land in 'scratch', so 'in' and 'out' may be the same.
+//
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::Codelets ( std::complex<T> const * in, std::complex<T> * out, std::complex<T> * scratch ) const
+{
+	constexpr size_t R  = codelet_cols_v<FFTSZ> ;
+	constexpr size_t N1 = codelet_rows_v<FFTSZ> ;
+	constexpr size_t L  = codelet_lanes_v<T> ;
+	using column = codelet<T, N1, L, Invert> ;
+	using row    = codelet<T, R,  L, Invert> ;
+	static_assert(N1 % L == 0, "codelet lanes must divide the rows");
+	alignas ( 64 ) T re [ R * L ] ;
+	alignas ( 64 ) T im [ R * L ] ;
+
+	for ( size_t n2 = 0; n2 < R; n2 += L )
+	{
+		for ( size_t n1 = 0; n1 < N1; ++n1 )
+			for ( size_t l = 0; l < L; ++l )
 			{
-				// wwf2 = ww*f2
-				wwf2 = *ww * *f2 ;
-				// t1 = f1+wwf2
-				*t1 = *f1 + wwf2 ;
-				// t2 = f1-wwf2
-				*t2 = *f1 - wwf2 ;
-				// increment
-				f1 += 2*k; f2 += 2*k;
-				t1 += k; t2 += k;
-				ww += k;
+				re[n1 * L + l] = in[R * n1 + n2 + l].real () ;
+				im[n1 * L + l] = in[R * n1 + n2 + l].imag () ;
+				if constexpr ( Invert != 1 )
+				{
+					re[n1 * L + l] /= div_ ;
+					im[n1 * L + l] /= div_ ;
+				}
 			}
+		column::apply ( re, im ) ;
+		for ( size_t l = 0; l < L; ++l )
+			for ( size_t k1 = 0; k1 < N1; ++k1 )
+				scratch[( n2 + l ) * N1 + k1] = std::complex<T> ( re[column::rev ( k1 ) * L + l], im[column::rev ( k1 ) * L + l] ) ;
+	}
+	std::complex<T> const * w = codelet_twiddles_v<T, FFTSZ, Invert>.data () ;
+	for ( size_t k1 = 0; k1 < N1; k1 += L )
+	{
+		for ( size_t n2 = 0; n2 < R; ++n2 )
+			for ( size_t l = 0; l < L; ++l )
+			{
+				auto const x = scratch[n2 * N1 + k1 + l] ;
+				auto const t = w[n2 * N1 + k1 + l] ;
+				re[n2 * L + l] = x.real () * t.real () - x.imag () * t.imag () ;
+				im[n2 * L + l] = x.real () * t.imag () + x.imag () * t.real () ;
+			}
+		row::apply ( re, im ) ;
+		for ( size_t k2 = 0; k2 < R; ++k2 )
+			for ( size_t l = 0; l < L; ++l )
+				out[k1 + l + N1 * k2] = std::complex<T> ( re[row::rev ( k2 ) * L + l], im[row::rev ( k2 ) * L + l] ) ;
+	}
+}
+
+// the butterflies that can't affect the bins wanted are found working back from the
+// last stage, each stage needing the inputs of the run after it, taken as one run.
+// The run doubles back at each stage so the saving is in the last log2(N / count).
+// With input zero beyond 'live' every stage's output is zero in the positions whose
+// offset within the half span is at least 'live', so those butterflies are skipped
+// and those whose second input is zero are copies. The saving is in the first log2(N / live).
+//
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::operator () ( std::complex<T> const * in, std::complex<T> * out, size_t live, size_t first, size_t count )
+{
+	( *this ) ( in, out, live, first, count, Buffer ()) ;
+}
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::operator () ( std::complex<T> const * in, std::complex<T> * out, size_t live, size_t first, size_t count, std::complex<T> * scratch ) const
+{
+	constexpr size_t lgN  = std::bit_width ( FFTSZ ) - 1 ;
+	constexpr size_t half = FFTSZ / 2 ;
+	live = std::clamp<size_t> ( live, 1, FFTSZ ) ;
+
+	// { first, count } butterflies of each stage, modulo FFTSZ / 2.
+	std::array<std::pair<size_t, size_t>, lgN> runs ;
+	size_t f = first ;
+	size_t c = std::min ( count, half ) ;
+	for ( size_t i = lgN; i-- > 0; )
+	{
+		size_t const k = half >> i ;
+		f &= half - 1 ;
+		runs[i] = { f, c } ;
+		// the positions read by butterflies f to f + c - 1.
+		size_t const b = f + c - 1 ;
+		size_t const lo = 2 * ( f & ~( k - 1 )) + ( f & ( k - 1 )) ;
+		size_t const hi = 2 * ( b & ~( k - 1 )) + ( b & ( k - 1 )) + k ;
+		f = lo ;
+		c = std::min ( half, hi - lo + 1 ) ;
+	}
+
+	std::complex<T> * to_ ;
+	std::complex<T> * from_ ;
+	if ( lgN % 2 == 0)
+	{
+		from_ = out ;
+		to_   = scratch ;
+	}
+	else
+	{
+		to_		= out ;
+		from_	= scratch ;
+	}
+
+	using namespace std::placeholders;
+	std::transform ( in, in + live, from_, std::bind ( std::divides<std::complex<T> >(), _1, div_ )) ;
+
+	for ( size_t i = 0; i < lgN; ++i )
+	{
+		size_t const k = half >> i ;
+		if ( runs[i].second == half && live >= 2 * k )
+		{
+			if ( k >= strategy_.split )
+				StageBlocked ( k, from_, to_ ) ;
+			else
+				StageStrided ( k, from_, to_ ) ;
 		}
+		else
+			StagePruned ( k, from_, to_, runs[i].first, runs[i].second, live ) ;
 		std::swap ( from_, to_ ) ;
 	}
 }
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::StageStrided ( size_t k, std::complex<T> const* from, std::complex<T> * to ) const
+{
+	for ( size_t s = 0; s < k; ++s )
+	{
+		// initialize pointers
+		std::complex<T> const * f1, * f2 ;
+		std::complex<C> const * ww ;
+		std::complex<T> * t1, * t2 ;
+		std::complex<C> wwf2 ;
+		f1 = &from[s]; f2 = &from[s+k];
+		t1 = &to[s]; t2 = &to[s+FFTSZ/2];
+		ww = w_;
+		// compute <s,k>
+		while ( ww < w_ + FFTSZ / 2)
+		{
+			// wwf2 = ww*f2
+			wwf2 = *ww * std::complex<C> ( *f2 ) ;
+			// t1 = f1+wwf2
+			*t1 = std::complex<T> ( std::complex<C> ( *f1 ) + wwf2 ) ;
+			// t2 = f1-wwf2
+			*t2 = std::complex<T> ( std::complex<C> ( *f1 ) - wwf2 ) ;
+			// increment
+			f1 += 2*k; f2 += 2*k;
+			t1 += k; t2 += k;
+			ww += k;
+		}
+	}
+}
+
+// same butterflies as StageStrided, but with the twiddle loop outermost
+// each inner pass reads and writes four contiguous runs of 'k'.
+//
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::StageBlocked ( size_t k, std::complex<T> const* from, std::complex<T> * to ) const
+{
+	for ( size_t j = 0; j < FFTSZ / 2; j += k )
+	{
+		C const wr = w_[j].real() ;
+		C const wi = w_[j].imag() ;
+		std::complex<T> const * f1 = from + 2 * j ;
+		std::complex<T> const * f2 = f1 + k ;
+		std::complex<T> * t1 = to + j ;
+		std::complex<T> * t2 = t1 + FFTSZ / 2 ;
+		for ( size_t s = 0; s < k; ++s )
+		{
+			// spelt out, std::complex multiplication checks for infinities and won't vectorise.
+			C const xr = wr * C ( f2[s].real() ) - wi * C ( f2[s].imag() ) ;
+			C const xi = wr * C ( f2[s].imag() ) + wi * C ( f2[s].real() ) ;
+			t1[s] = std::complex<T> ( T ( C ( f1[s].real() ) + xr ), T ( C ( f1[s].imag() ) + xi )) ;
+			t2[s] = std::complex<T> ( T ( C ( f1[s].real() ) - xr ), T ( C ( f1[s].imag() ) - xi )) ;
+		}
+	}
+}
+
+// the stages of half span k and k / 2 in one pass, each group of four points read from T, both
+// stages' butterflies done in C, and the results rounded back to T once. The strategy orders the
+// groups as it does the butterflies of a single stage, each twiddle's together from span 'split'.
+//
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::StagePair ( size_t k, std::complex<T> const* from, std::complex<T> * to ) const
+{
+	size_t const h = k / 2 ;
+	size_t const groups = FFTSZ / ( 2 * k ) ;
+	// spelt out, std::complex multiplication checks for infinities and won't vectorise.
+	auto group = [ this, k, h, from, to ] ( size_t m, size_t s )
+	{
+		std::complex<C> const w1 = w_[m * k] ;
+		std::complex<C> const w2 = w_[m * h] ;
+		std::complex<C> const w3 = w_[m * h + FFTSZ / 4] ;
+		std::complex<T> const* f = from + 2 * m * k + s ;
+		C const a0r = f[0].real (),     a0i = f[0].imag () ;
+		C const a1r = f[h].real (),     a1i = f[h].imag () ;
+		C const b0r = f[k].real (),     b0i = f[k].imag () ;
+		C const b1r = f[k + h].real (), b1i = f[k + h].imag () ;
+		// the first stage.
+		C const x0r = w1.real () * b0r - w1.imag () * b0i ;
+		C const x0i = w1.real () * b0i + w1.imag () * b0r ;
+		C const x1r = w1.real () * b1r - w1.imag () * b1i ;
+		C const x1i = w1.real () * b1i + w1.imag () * b1r ;
+		C const p0r = a0r + x0r, p0i = a0i + x0i ;
+		C const p1r = a1r + x1r, p1i = a1i + x1i ;
+		C const q0r = a0r - x0r, q0i = a0i - x0i ;
+		C const q1r = a1r - x1r, q1i = a1i - x1i ;
+		// the second, the sums in the first half, the differences in the second.
+		C const yr = w2.real () * p1r - w2.imag () * p1i ;
+		C const yi = w2.real () * p1i + w2.imag () * p1r ;
+		C const zr = w3.real () * q1r - w3.imag () * q1i ;
+		C const zi = w3.real () * q1i + w3.imag () * q1r ;
+		std::complex<T> * t = to + m * h + s ;
+		t[0]                     = std::complex<T> ( T ( p0r + yr ), T ( p0i + yi )) ;
+		t[FFTSZ / 2]             = std::complex<T> ( T ( p0r - yr ), T ( p0i - yi )) ;
+		t[FFTSZ / 4]             = std::complex<T> ( T ( q0r + zr ), T ( q0i + zi )) ;
+		t[FFTSZ / 4 + FFTSZ / 2] = std::complex<T> ( T ( q0r - zr ), T ( q0i - zi )) ;
+	} ;
+	if ( h >= strategy_.split )
+	{
+		for ( size_t m = 0; m < groups; ++m )
+			for ( size_t s = 0; s < h; ++s )
+				group ( m, s ) ;
+	}
+	else
+	{
+		for ( size_t s = 0; s < h; ++s )
+			for ( size_t m = 0; m < groups; ++m )
+				group ( m, s ) ;
+	}
+}
+
+// StageBlocked over butterflies 'first' to 'first + count' only. Those whose second
+// input is beyond 'live' copy the first, those whose first is beyond are not written.
+//
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::StagePruned ( size_t k, std::complex<T> const* from, std::complex<T> * to, size_t first, size_t count, size_t live ) const
+{
+	for ( size_t n = 0; n < count; )
+	{
+		size_t const m  = ( first + n ) & ( FFTSZ / 2 - 1 ) ;
+		size_t const j  = m & ~( k - 1 ) ;
+		size_t const s0 = m - j ;
+		size_t const s1 = std::min ( k, s0 + count - n ) ;
+		size_t const sf = std::clamp ( live > k ? live - k : 0, s0, s1 ) ;
+		size_t const sc = std::clamp ( live, sf, s1 ) ;
+		C const wr = w_[j].real() ;
+		C const wi = w_[j].imag() ;
+		std::complex<T> const * f1 = from + 2 * j ;
+		std::complex<T> const * f2 = f1 + k ;
+		std::complex<T> * t1 = to + j ;
+		std::complex<T> * t2 = t1 + FFTSZ / 2 ;
+		for ( size_t s = s0; s < sf; ++s )
+		{
+			C const xr = wr * C ( f2[s].real() ) - wi * C ( f2[s].imag() ) ;
+			C const xi = wr * C ( f2[s].imag() ) + wi * C ( f2[s].real() ) ;
+			t1[s] = std::complex<T> ( T ( C ( f1[s].real() ) + xr ), T ( C ( f1[s].imag() ) + xi )) ;
+			t2[s] = std::complex<T> ( T ( C ( f1[s].real() ) - xr ), T ( C ( f1[s].imag() ) - xi )) ;
+		}
+		for ( size_t s = sf; s < sc; ++s )
+		{
+			t1[s] = f1[s] ;
+			t2[s] = f1[s] ;
+		}
+		n += s1 - s0 ;
+	}
+}
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+void FFT<T, FFTSZ, Invert, C>::Strategy ( fft_strategy_t st )
+{
+	strategy_ = st ;
+}
+
+template < typename T, size_t FFTSZ, int Invert, typename C>
+fft_strategy_t FFT<T, FFTSZ, Invert, C>::Strategy () const
+{
+	return strategy_ ;
+}
@@ -0,0 +1,36 @@
+//
+//	Parallel.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// split [0, n) into contiguous chunks of at least 'grain' and call fn ( b, e ) for each,
+// one chunk per hardware thread. The calling thread does the first chunk itself and
+// anything too small to be worth a thread is done inline.
+//
+template <typename F> void parallel_for ( size_t n, size_t grain, F fn )
+{
+	size_t const hw = std::max<size_t> ( 1, std::thread::hardware_concurrency ()) ;
+	size_t const chunks = std::min ( hw, n / std::max<size_t> ( grain, 1 )) ;
+	if ( chunks <= 1 )
+	{
+		fn ( size_t { 0 }, n ) ;
+		return ;
+	}
+	size_t const per = ( n + chunks - 1 ) / chunks ;
+	std::vector<std::thread> workers ;
+	workers.reserve ( chunks - 1 ) ;
+	for ( size_t b = per; b < n; b += per )
+		workers.emplace_back ( [ &fn, b, e = std::min ( n, b + per ) ] () { fn ( b, e ) ; } ) ;
+	fn ( size_t { 0 }, per ) ;
+	for ( auto& t : workers )
+		t.join () ;
+}
@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <complex>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <bit>
+
+#include "fftlib.h"
+
+#include "FFT.h"
+#include "PeakFinder.h"
+
+namespace
+{
+	// the window is sampled this long to find its transform, long enough that the lobe has its limiting shape.
+	const size_t LobeWindow = 1024;
+	// offsets from 0 to half a bin tabulated.
+	const size_t LobeSteps = 64;
+	// flags are made and read back this many bins at a time, so they stay in L1.
+	const size_t ScanBlock = 4096;
+
+	// |W(d)| / W(0), the window's transform d bins from its centre.
+	double lobe_height(window_t wt, double d)
+	{
+		std::complex<double> s;
+		double s0 = 0;
+		for (size_t n = 0; n < LobeWindow; ++n)
+		{
+			double const w = window_coefficient(wt, n, LobeWindow);
+			s += std::polar(w, -2 * std::numbers::pi * d * static_cast<double>(n) / LobeWindow);
+			s0 += w;
+		}
+		return std::abs(s) / s0;
+	}
+}
+
+PeakFinder::PeakFinder(window_t wt)
+{
+	Lobe(wt);
+}
+
+void PeakFinder::Lobe(window_t wt)
+{
+	lobe_.resize(LobeSteps + 1);
+	ratio_.resize(LobeSteps + 1);
+	for (size_t i = 0; i <= LobeSteps; ++i)
+	{
+		double const d = 0.5 * static_cast<double>(i) / LobeSteps;
+		lobe_[i] = lobe_height(wt, d);
+		ratio_[i] = lobe_height(wt, 1.0 - d) / lobe_[i];
+	}
+}
+
+// the peak at bin k of m[0, n). The larger neighbour is on the side of the true peak, and
+// their ratio rises monotonically from ratio_[0] to 1 as the offset goes from 0 to half a bin.
+peak_t PeakFinder::Refine(fp_t const* m, size_t n, size_t k) const
+{
+	fp_t const l = k > 0 ? m[k - 1] : fp_t(0);
+	fp_t const r = k + 1 < n ? m[k + 1] : fp_t(0);
+	fp_t const side = std::max(l, r);
+	if (m[k] <= 0)
+		return { static_cast<double>(k), m[k] };
+	double const q = std::clamp(static_cast<double>(side) / m[k], ratio_.front(), ratio_.back());
+	size_t const i = std::min<size_t>(LobeSteps - 1, std::upper_bound(ratio_.begin(), ratio_.end(), q) - ratio_.begin() - 1);
+	double const t = ratio_[i + 1] > ratio_[i] ? (q - ratio_[i]) / (ratio_[i + 1] - ratio_[i]) : 0.0;
+	double const d = 0.5 * (static_cast<double>(i) + t) / LobeSteps;
+	double const h = lobe_[i] + t * (lobe_[i + 1] - lobe_[i]);
+	return { static_cast<double>(k) + (r >= l ? d : -d), static_cast<fp_t>(m[k] / h) };
+}
+
+size_t PeakFinder::operator () (fp_t const* b, fp_t const* e, fp_t threshold, size_t min_separation, peak_t* out, size_t max_peaks)
+{
+	size_t const n = e - b;
+	candidates_.clear();
+	if (n < 3 || max_peaks == 0)
+		return 0;
+
+	// local maxima above the threshold, first the flags, then the few that are set.
+	flags_.resize(ScanBlock);
+	for (size_t b0 = 1; b0 < n - 1; b0 += ScanBlock)
+	{
+		size_t const b1 = std::min(n - 1, b0 + ScanBlock);
+		uint8_t* f = flags_.data();
+		for (size_t i = b0; i < b1; ++i)
+			f[i - b0] = (b[i] > b[i - 1]) & (b[i] >= b[i + 1]) & (b[i] > threshold);
+		for (size_t i = b0; i < b1; ++i)
+			if (f[i - b0])
+				candidates_.push_back({ i, b[i] });
+	}
+
+	// strongest first, each kept unless a stronger one is too close.
+	std::sort(candidates_.begin(), candidates_.end(), [](auto const& x, auto const& y) { return x.mag > y.mag; });
+	size_t found = 0;
+	for (auto const& c : candidates_)
+	{
+		if (std::none_of(out, out + found, [&](peak_t const& p)
+			{
+				return std::abs(static_cast<double>(c.bin) - p.bin) < static_cast<double>(min_separation);
+			}))
+		{
+			out[found++] = Refine(b, n, c.bin);
+			if (found == max_peaks)
+				break;
+		}
+	}
+	return found;
+}
+
+std::unique_ptr<IPeakFinder> make_peak_finder(window_t wt)
+{
+	return std::make_unique<PeakFinder>(wt);
+}
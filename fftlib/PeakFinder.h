@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <vector>
+
+// peaks in magnitude spectra. Candidates are marked in a branch free pass
+// over the spectrum, a block at a time, the strongest taken subject to the
+// separation, and each refined by the shape of the window's main lobe, known
+// from its transform: the ratio of the peak bin to its larger neighbour
+// gives the offset of the true frequency, and the lobe height there the amplitude.
+//
+class PeakFinder : public IPeakFinder
+{
+private :
+	struct candidate_t
+	{
+		size_t bin ;
+		fp_t   mag ;
+	} ;
+
+	// the main lobe, lobe_[i] is its height at an offset of i / ( 2 * ( size - 1 )) bins,
+	// ratio_[i] the height one bin further out relative to it.
+	std::vector<double> lobe_ ;
+	std::vector<double> ratio_ ;
+
+	// working spaces
+	std::vector<uint8_t> flags_ ;
+	std::vector<candidate_t> candidates_ ;
+
+	void Lobe ( window_t wt ) ;
+	peak_t Refine ( fp_t const* m, size_t n, size_t k ) const ;
+
+public :
+	explicit PeakFinder ( window_t wt ) ;
+	virtual size_t operator () ( fp_t const* b, fp_t const* e, fp_t threshold, size_t min_separation, peak_t * out, size_t max_peaks ) final ;
+} ;
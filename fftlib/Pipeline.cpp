@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <complex>
+#include <algorithm>
+#include <memory>
+
+#include "fftlib.h"
+
+#include "Pipeline.h"
+
+namespace
+{
+	// an idle worker spins this many times, then yields this many more, then naps.
+	const size_t IdleSpins  = 64;
+	const size_t IdleYields = 256;
+	// a nap is the most a worker can add to a frame's latency, well inside a hop at any sensible width and rate.
+	const auto   IdleNap    = std::chrono::microseconds(100);
+
+	void backoff(size_t idle)
+	{
+		if (idle < IdleSpins)
+			return;
+		if (idle < IdleSpins + IdleYields)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(IdleNap);
+	}
+}
+
+PipelineFFT::worker_t::worker_t(std::unique_ptr<IProcessorFFT> fft, size_t depth) :
+	fft_(std::move(fft)), in_(depth, frame_t{ {}, std::vector<fp_t>(fft_->width()) }), out_(depth, spectrum_t{ std::vector<fp_t>(fft_->width() / 2) }),
+	frames_(0), max_latency_ns_(0)
+{
+}
+
+PipelineFFT::PipelineFFT(size_t width, window_t wt, size_t workers, size_t depth) : width_(size_t(1) << width), stop_(false),
+	stage_(width_), fill_(0), next_in_(0), overruns_(0), dispatched_(0), next_out_(0), taken_(0)
+{
+	for (size_t n = 0; n < std::max<size_t>(workers, 1); ++n)
+		workers_.push_back(std::make_unique<worker_t>(make_fft(width, wt), depth));
+	// every allocation is done before any thread starts.
+	for (auto& w : workers_)
+		w->thread_ = std::thread([this, &w = *w]() { Work(w); });
+}
+
+PipelineFFT::~PipelineFFT()
+{
+	stop_.store(true, std::memory_order_relaxed);
+	for (auto& w : workers_)
+		w->thread_.join();
+}
+
+void PipelineFFT::push(fp_t const* b, fp_t const* e)
+{
+	while (b != e)
+	{
+		size_t const n = std::min<size_t>(e - b, width_ - fill_);
+		std::copy(b, b + n, stage_.begin() + fill_);
+		fill_ += n;
+		b += n;
+		if (fill_ < width_)
+			break;
+
+		// a frame is complete, hand it to the next worker in turn if it has room.
+		auto& w = *workers_[next_in_];
+		if (frame_t* f = w.in_.acquire())
+		{
+			std::copy(stage_.begin(), stage_.end(), f->samples_.begin());
+			f->arrived_ = clock::now();
+			w.in_.publish();
+			dispatched_.store(dispatched_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			next_in_ = (next_in_ + 1) % workers_.size();
+		}
+		else
+			overruns_.fetch_add(1, std::memory_order_relaxed);
+
+		// the second half starts the next frame, dropped or not.
+		std::copy(stage_.begin() + width_ / 2, stage_.end(), stage_.begin());
+		fill_ = width_ / 2;
+	}
+}
+
+void PipelineFFT::Work(worker_t& w)
+{
+	size_t idle = 0;
+	while (!stop_.load(std::memory_order_relaxed))
+	{
+		frame_t* f = w.in_.front();
+		spectrum_t* s = f ? w.out_.acquire() : nullptr;
+		if (!s)
+		{
+			backoff(idle++);
+			continue;
+		}
+		idle = 0;
+		auto [ob, oe] = (*w.fft_) (f->samples_.data(), f->samples_.data() + width_);
+		std::copy(ob, oe, s->mags_.begin());
+		auto const arrived = f->arrived_;
+		w.in_.release();
+		w.out_.publish();
+
+		auto const ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - arrived).count());
+		if (ns > w.max_latency_ns_.load(std::memory_order_relaxed))
+			w.max_latency_ns_.store(ns, std::memory_order_relaxed);
+		w.frames_.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+fp_t const* PipelineFFT::front()
+{
+	spectrum_t* s = workers_[next_out_]->out_.front();
+	return s ? s->mags_.data() : nullptr;
+}
+
+void PipelineFFT::release()
+{
+	workers_[next_out_]->out_.release();
+	next_out_ = (next_out_ + 1) % workers_.size();
+	++taken_;
+}
+
+bool PipelineFFT::drained()
+{
+	return taken_ == dispatched_.load(std::memory_order_acquire);
+}
+
+pipeline_stats_t PipelineFFT::stats() const
+{
+	pipeline_stats_t st{ 0, overruns_.load(std::memory_order_relaxed), 0 };
+	for (auto& w : workers_)
+	{
+		st.frames += w->frames_.load(std::memory_order_relaxed);
+		st.max_latency_ns = std::max(st.max_latency_ns, w->max_latency_ns_.load(std::memory_order_relaxed));
+	}
+	return st;
+}
+
+std::unique_ptr<IPipelineFFT> make_fft_pipeline(size_t width, window_t wt, size_t workers, size_t depth)
+{
+	if (width < FFTWdMin || width > FFTWdMax || workers == 0 || depth == 0)
+		return std::unique_ptr<IPipelineFFT>();
+	return std::make_unique<PipelineFFT>(width, wt, workers, depth);
+}
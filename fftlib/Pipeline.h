@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "SPSCRing.h"
+
+// live analysis. The producer cuts what it is given into half overlapping
+// frames and deals them out to the workers in turn, each through its own
+// ring, and the consumer collects the spectra from the workers in the same
+// turn, so every ring has one producer and one consumer and order is kept.
+// Frames and spectra are transformed and read in place in the ring slots.
+//
+class PipelineFFT : public IPipelineFFT
+{
+private :
+	using clock = std::chrono::steady_clock ;
+
+	struct frame_t
+	{
+		clock::time_point arrived_ ;
+		std::vector<fp_t> samples_ ;
+	} ;
+	struct spectrum_t
+	{
+		std::vector<fp_t> mags_ ;
+	} ;
+	struct worker_t
+	{
+		std::unique_ptr<IProcessorFFT> fft_ ;
+		spsc_ring<frame_t>    in_ ;
+		spsc_ring<spectrum_t> out_ ;
+		// written only by the worker.
+		std::atomic<uint64_t> frames_ ;
+		std::atomic<uint64_t> max_latency_ns_ ;
+		std::thread thread_ ;
+
+		worker_t ( std::unique_ptr<IProcessorFFT> fft, size_t depth ) ;
+	} ;
+
+	size_t const width_ ;
+	std::vector<std::unique_ptr<worker_t>> workers_ ;
+	std::atomic<bool> stop_ ;
+
+	// producer, the previous hop then the one filling.
+	std::vector<fp_t> stage_ ;
+	size_t fill_ ;
+	size_t next_in_ ;
+	std::atomic<uint64_t> overruns_ ;
+	std::atomic<uint64_t> dispatched_ ;
+
+	// consumer
+	size_t next_out_ ;
+	uint64_t taken_ ;
+
+	void Work ( worker_t& w ) ;
+
+public :
+	PipelineFFT ( size_t width, window_t wt, size_t workers, size_t depth ) ;
+	virtual ~PipelineFFT () final ;
+	virtual void push ( fp_t const* b, fp_t const* e ) final ;
+	virtual fp_t const* front () final ;
+	virtual void release () final ;
+	virtual bool drained () final ;
+	virtual size_t width () final { return width_ ; }
+	virtual pipeline_stats_t stats () const final ;
+} ;
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include "ProcConvolution.h"
+
+// the analytic signal x + iH(x). The Hilbert transform is a real FIR, the
+// ideal 2 / (pi.m) at odd offsets m from its centre, Kaiser windowed, odd
+// and short enough to be one partition of a convolver, so two blocks go
+// through one forward and one inverse transform. The real part is the
+// input delayed to the kernel's centre. Amplitude and frequency come from
+// each sample of that and the one before.
+//
+template <typename T, size_t FFTSZ> class ProcessorAnalytic : public IAnalyticSignal
+{
+private :
+	// Hilbert kernel taps, and where its centre is.
+	static constexpr size_t taps_  = FFTSZ / 2 - 1 ;
+	static constexpr size_t delay_ = ( taps_ - 1 ) / 2 ;
+
+	ProcessorConvolution<T, FFTSZ> hilbert_ ;
+	// the last delay_ samples in, and the last analytic sample out.
+	std::array<T, delay_> tail_ ;
+	std::complex<T> last_ ;
+
+	// working spaces
+	std::array<T, FFTSZ> im_ ;
+
+	static std::vector<T> Kernel () ;
+	explicit ProcessorAnalytic ( std::vector<T> const& k ) ;
+
+public :
+	ProcessorAnalytic () ;
+	virtual void operator () ( T const* in, std::complex<T>* z, T* amplitude, T* frequency ) final ;
+	virtual size_t block () final { return FFTSZ ; }
+	virtual size_t delay () final { return delay_ ; }
+	virtual void reset () final ;
+	void Strategy ( fft_strategy_t st ) { hilbert_.Strategy ( st ) ; }
+} ;
+
+#include "ProcAnalyticImpl.h"
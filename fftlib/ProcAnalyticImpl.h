@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+template <typename T, size_t FFTSZ>
+std::vector<T> ProcessorAnalytic<T, FFTSZ>::Kernel ()
+{
+	std::vector<T> k ( taps_, T { 0 } ) ;
+	// the Kaiser coefficients aren't normalised, this is the centre's.
+	double const w0 = window_coefficient ( window_t::KAISER7, delay_, taps_ ) ;
+	for ( size_t n = 1; n <= delay_; n += 2 )
+	{
+		double const h = 2.0 / ( std::numbers::pi * static_cast<double>( n )) * window_coefficient ( window_t::KAISER7, delay_ + n, taps_ ) / w0 ;
+		k[delay_ + n] = static_cast<T>( h ) ;
+		k[delay_ - n] = static_cast<T>( -h ) ;
+	}
+	return k ;
+}
+
+template <typename T, size_t FFTSZ>
+ProcessorAnalytic<T, FFTSZ>::ProcessorAnalytic () : ProcessorAnalytic ( Kernel ())
+{
+}
+
+template <typename T, size_t FFTSZ>
+ProcessorAnalytic<T, FFTSZ>::ProcessorAnalytic ( std::vector<T> const& k ) : hilbert_ ( k.data (), k.data () + k.size ())
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+	reset () ;
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorAnalytic<T, FFTSZ>::reset ()
+{
+	hilbert_.reset () ;
+	std::fill ( tail_.begin (), tail_.end (), T { 0 } ) ;
+	last_ = std::complex<T> () ;
+}
+
+// FFTSZ samples in, and out delay_ samples later.
+template <typename T, size_t FFTSZ>
+void ProcessorAnalytic<T, FFTSZ>::operator () ( T const* in, std::complex<T>* z, T* amplitude, T* frequency )
+{
+	hilbert_ ( in, im_.data (), 1 ) ;
+	for ( size_t n = 0; n < delay_; ++n )
+		z[n] = std::complex<T> ( tail_[n], im_[n] ) ;
+	for ( size_t n = delay_; n < FFTSZ; ++n )
+		z[n] = std::complex<T> ( in[n - delay_], im_[n] ) ;
+	std::copy ( in + FFTSZ - delay_, in + FFTSZ, tail_.begin ()) ;
+
+	if ( amplitude )
+	{
+		for ( size_t n = 0; n < FFTSZ; ++n )
+			amplitude[n] = std::sqrt ( z[n].real () * z[n].real () + z[n].imag () * z[n].imag ()) ;
+	}
+	if ( frequency )
+	{
+		// the phase advance, arg ( z[n] . z*[n - 1] ), in cycles.
+		T const scale = T ( 0.5 / std::numbers::pi ) ;
+		std::complex<T> prev = last_ ;
+		for ( size_t n = 0; n < FFTSZ; ++n )
+		{
+			T const re = z[n].real () * prev.real () + z[n].imag () * prev.imag () ;
+			T const im = z[n].imag () * prev.real () - z[n].real () * prev.imag () ;
+			frequency[n] = std::atan2 ( im, re ) * scale ;
+			prev = z[n] ;
+		}
+	}
+	last_ = z[FFTSZ - 1] ;
+}
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <complex>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <bit>
+
+#include "fftlib.h"
+
+#include "FFTCore.h"
+#include "ProcCQT.h"
+
+namespace
+{
+	// kernel coefficients smaller than this, relative to the largest in their kernel, are dropped.
+	const double KernelThreshold = 0.0054;
+}
+
+ProcessorCQT::ProcessorCQT(size_t width, window_t wt, double sample_rate, std::vector<double> freq, double Q, double threshold) : width_(size_t(1) << width),
+	fft_(make_fft_core(width, 1)), freq_(std::move(freq)), pack_(width_), packed_(width_), x_(width_ / 2 + 1), y_(width_ / 2 + 1),
+	out_(freq_.size())
+{
+	Kernels(wt, sample_rate, Q, threshold);
+}
+
+// bin k's temporal kernel is w[n] / sum(w) * exp(2*PI*i*f[k]*n/fs), Q / f[k] seconds long, centred in the
+// frame. By Parseval the sum over the frame of x * conj(kernel) is the sum over the spectrum of X * conj(K) / N,
+// and only K's positive frequencies are significant, so a sine of amplitude A at f[k] gives A / 2.
+//
+void ProcessorCQT::Kernels(window_t wt, double sample_rate, double Q, double threshold)
+{
+	std::vector<std::complex<fp_t>> temporal(width_);
+	std::vector<std::complex<fp_t>> spectral(width_);
+	row_.assign(1, 0);
+	for (double f : freq_)
+	{
+		size_t const len = std::min(width_, static_cast<size_t>(std::ceil(Q * sample_rate / f)));
+		size_t const start = (width_ - len) / 2;
+		double sum = 0;
+		for (size_t n = 0; n < len; ++n)
+			sum += window_coefficient(wt, n, len);
+		std::fill(temporal.begin(), temporal.end(), std::complex<fp_t>());
+		for (size_t n = 0; n < len; ++n)
+		{
+			double const ph = 2 * std::numbers::pi * f * static_cast<double>(n) / sample_rate;
+			temporal[start + n] = std::polar(static_cast<fp_t>(window_coefficient(wt, n, len) / sum), static_cast<fp_t>(ph));
+		}
+		(*fft_) (temporal.data(), spectral.data());
+
+		double peak = 0;
+		for (size_t j = 0; j <= width_ / 2; ++j)
+			peak = std::max<double>(peak, std::abs(spectral[j]));
+		for (size_t j = 0; j <= width_ / 2; ++j)
+		{
+			if (std::abs(spectral[j]) >= threshold * peak)
+			{
+				col_.push_back(static_cast<uint32_t>(j));
+				val_.push_back(std::conj(spectral[j]) / static_cast<fp_t>(width_));
+			}
+		}
+		row_.push_back(val_.size());
+	}
+}
+
+// magnitudes scaled as IProcessorFFT, twice the modulus of the product.
+void ProcessorCQT::Apply(std::complex<fp_t> const* x, fp_t* out) const
+{
+	for (size_t k = 0; k + 1 < row_.size(); ++k)
+	{
+		fp_t re = 0;
+		fp_t im = 0;
+		for (size_t i = row_[k]; i < row_[k + 1]; ++i)
+		{
+			auto const a = x[col_[i]];
+			auto const b = val_[i];
+			re += a.real() * b.real() - a.imag() * b.imag();
+			im += a.real() * b.imag() + a.imag() * b.real();
+		}
+		out[k] = fp_t(2) * std::sqrt(re * re + im * im);
+	}
+}
+
+// two frames for one transform, the spectra separated by their conjugate symmetry. Only 'live' of
+// 'a' are read, the rest of its frame taken as zeros, and all of 'b'.
+void ProcessorCQT::Pair(fp_t const* a, size_t live, fp_t const* b, fp_t* oa, fp_t* ob)
+{
+	for (size_t n = 0; n < width_; ++n)
+		pack_[n] = std::complex<fp_t>(n < live ? a[n] : fp_t(0), b ? b[n] : fp_t(0));
+	(*fft_) (pack_.data(), packed_.data());
+	for (size_t k = 0; k <= width_ / 2; ++k)
+	{
+		auto const z  = packed_[k];
+		auto const zc = std::conj(packed_[(width_ - k) & (width_ - 1)]);
+		x_[k] = (z + zc) * fp_t(0.5);
+		y_[k] = (z - zc) * std::complex<fp_t>(0, fp_t(-0.5));
+	}
+	Apply(x_.data(), oa);
+	if (b)
+		Apply(y_.data(), ob);
+}
+
+std::pair<fp_t const*, fp_t const*> ProcessorCQT::operator () (fp_t const* ib, fp_t const* ie)
+{
+	Pair(ib, std::min<size_t>(ie - ib, width_), nullptr, out_.data(), nullptr);
+	return std::make_pair(out_.data(), out_.data() + out_.size());
+}
+
+void ProcessorCQT::operator () (fp_t const* ib, size_t frames, size_t hop, fp_t* out)
+{
+	size_t const nb = freq_.size();
+	for (size_t f = 0; f < frames; f += 2)
+	{
+		fp_t const* a = ib + f * hop;
+		fp_t const* b = f + 1 < frames ? a + hop : nullptr;
+		Pair(a, width_, b, out + f * nb, out + (f + 1) * nb);
+	}
+}
+
+std::unique_ptr<IProcessorCQT> make_cqt(double sample_rate, double f_min, double f_max, size_t bins_per_octave, window_t wt)
+{
+	if (sample_rate <= 0 || f_min <= 0 || f_max < f_min || f_max > sample_rate / 2 || bins_per_octave == 0)
+		return std::unique_ptr<IProcessorCQT>();
+	double const bpo = static_cast<double>(bins_per_octave);
+	std::vector<double> freq;
+	for (size_t k = 0; k <= static_cast<size_t>(std::floor(bpo * std::log2(f_max / f_min) + 1e-9)); ++k)
+		freq.push_back(f_min * std::pow(2.0, static_cast<double>(k) / bpo));
+	// the frame must hold the longest kernel, the lowest bin's.
+	double const Q = 1.0 / (std::pow(2.0, 1.0 / bpo) - 1.0);
+	size_t const longest = static_cast<size_t>(std::ceil(Q * sample_rate / f_min));
+	size_t const width = std::max<size_t>(FFTWdMin, std::bit_width(std::bit_ceil(longest)) - 1);
+	if (width > FFTWdMax)
+		return std::unique_ptr<IProcessorCQT>();
+	return std::make_unique<ProcessorCQT>(width, wt, sample_rate, std::move(freq), Q, KernelThreshold);
+}
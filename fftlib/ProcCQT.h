@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "FFTCore.h"
+
+// constant-Q transform by spectral kernel (Brown and Puckette). Each bin's
+// temporal kernel, a window as long as Q periods of its centre frequency
+// modulated to that frequency, is transformed once at construction and only
+// its significant coefficients kept. A frame is then one FFT and a sparse
+// matrix-vector product with the kernels. Frames are transformed in pairs,
+// one as the real and one as the imaginary part of one complex transform.
+//
+class ProcessorCQT : public IProcessorCQT
+{
+private :
+	size_t const width_ ;
+	std::unique_ptr<IFFTCore<fp_t>> fft_ ;
+	std::vector<double> freq_ ;
+
+	// the kernels, compressed rows. Bin k's coefficients are val_[row_[k], row_[k + 1])
+	// for spectrum bins col_[row_[k], row_[k + 1]).
+	std::vector<size_t> row_ ;
+	std::vector<uint32_t> col_ ;
+	std::vector<std::complex<fp_t>> val_ ;
+
+	// working spaces
+	std::vector<std::complex<fp_t>> pack_ ;
+	std::vector<std::complex<fp_t>> packed_ ;
+	std::vector<std::complex<fp_t>> x_ ;
+	std::vector<std::complex<fp_t>> y_ ;
+	std::vector<fp_t> out_ ;
+
+	void Kernels ( window_t wt, double sample_rate, double Q, double threshold ) ;
+	void Apply ( std::complex<fp_t> const* x, fp_t * out ) const ;
+	void Pair ( fp_t const* a, size_t live, fp_t const* b, fp_t * oa, fp_t * ob ) ;
+
+public :
+	ProcessorCQT ( size_t width, window_t wt, double sample_rate, std::vector<double> freq, double Q, double threshold ) ;
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( fp_t const* ib, fp_t const* ie ) final ;
+	virtual void operator () ( fp_t const* ib, size_t frames, size_t hop, fp_t * out ) final ;
+	virtual size_t width () final { return width_ ; }
+	virtual size_t bins () final { return freq_.size () ; }
+	virtual double bin_frequency ( size_t k ) final { return freq_[k] ; }
+	virtual size_t kernel_size () final { return val_.size () ; }
+} ;
@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include "FFT.h"
+
+// uniformly partitioned overlap-save convolution. The kernel is cut into
+// partitions of FFTSZ / 2 taps and the spectrum of each, zero padded to
+// FFTSZ, is kept. Each FFTSZ / 2 samples in, the spectrum of them and the
+// ones before is added to a delay line of such spectra, the output spectrum
+// is the sum over partitions p of kernel spectrum p times the spectrum of p
+// blocks ago, and the last half of its inverse is the output block.
+// Everything is real, so blocks go two to a transform as its real and
+// imaginary parts, split to accumulate, and come back together from one
+// inverse. The kernel spectra are immutable and shared by clones.
+//
+template <typename T, size_t FFTSZ> class ProcessorConvolution : public IConvolver
+{
+private :
+	// the taps in each partition, and the samples each half of a call moves on.
+	static constexpr size_t part_ = FFTSZ / 2 ;
+	// the bins of a real sequence's spectrum that aren't the conjugates of others.
+	static constexpr size_t bins_ = FFTSZ / 2 + 1 ;
+
+	// partition p at p * bins_, real and imaginary apart so the products vectorise.
+	struct kernel_t
+	{
+		size_t partitions_ ;
+		std::vector<T> re_ ;
+		std::vector<T> im_ ;
+	} ;
+	std::shared_ptr<kernel_t const> kernel_ ;
+
+	// the spectra of the last partitions_ + 1 blocks, laid out as the kernel's, the newest at head_ - 1.
+	std::vector<T> xre_ ;
+	std::vector<T> xim_ ;
+	size_t head_ ;
+	// the previous block in.
+	std::array<T, part_> prev_ ;
+
+	// working spaces
+	std::array<T, bins_> y1re_ ;
+	std::array<T, bins_> y1im_ ;
+	std::array<T, bins_> y2re_ ;
+	std::array<T, bins_> y2im_ ;
+	std::array<std::complex<T>, FFTSZ> fftin_ ;
+	std::array<std::complex<T>, FFTSZ> fftout_ ;
+
+	// processor objects
+	FFT<T, FFTSZ>     fft_ ;
+	FFT<T, FFTSZ, -1> ifft_ ;
+
+	void Kernel ( T const* kb, T const* ke ) ;
+	size_t Slot ( size_t back ) const ;
+
+public :
+	ProcessorConvolution ( T const* kb, T const* ke ) ;
+	virtual void operator () ( T const* in, T* out, size_t stride ) final ;
+	virtual size_t block () final { return FFTSZ ; }
+	virtual size_t partitions () final { return kernel_->partitions_ ; }
+	virtual void reset () final ;
+	virtual std::unique_ptr<IConvolver> clone () const final ;
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; ifft_.Strategy ( st ) ; }
+} ;
+
+#include "ProcConvolutionImpl.h"
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+template <typename T, size_t FFTSZ>
+ProcessorConvolution<T, FFTSZ>::ProcessorConvolution ( T const* kb, T const* ke )
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+	Kernel ( kb, ke ) ;
+	xre_.resize (( kernel_->partitions_ + 1 ) * bins_ ) ;
+	xim_.resize (( kernel_->partitions_ + 1 ) * bins_ ) ;
+	reset () ;
+}
+
+// the spectrum of each partition, two to a transform.
+template <typename T, size_t FFTSZ>
+void ProcessorConvolution<T, FFTSZ>::Kernel ( T const* kb, T const* ke )
+{
+	size_t const taps = static_cast<size_t>( ke - kb ) ;
+	auto k = std::make_shared<kernel_t> () ;
+	k->partitions_ = std::max<size_t> ( 1, ( taps + part_ - 1 ) / part_ ) ;
+	k->re_.resize ( k->partitions_ * bins_ ) ;
+	k->im_.resize ( k->partitions_ * bins_ ) ;
+
+	auto tap = [ kb, taps ] ( size_t n ) { return n < taps ? kb[n] : T { 0 } ; } ;
+	std::fill ( fftin_.begin () + part_, fftin_.end (), std::complex<T> ()) ;
+	for ( size_t p = 0; p < k->partitions_; p += 2 )
+	{
+		for ( size_t n = 0; n < part_; ++n )
+			fftin_[n] = std::complex<T> ( tap ( p * part_ + n ), tap (( p + 1 ) * part_ + n )) ;
+		fft_ ( fftin_.data (), fftout_.data ()) ;
+		for ( size_t b = 0; b < bins_; ++b )
+		{
+			auto const [ x, y ] = split_pair<T, FFTSZ> ( fftout_.data (), b ) ;
+			k->re_[p * bins_ + b] = x.real () ;
+			k->im_[p * bins_ + b] = x.imag () ;
+			if ( p + 1 < k->partitions_ )
+			{
+				k->re_[( p + 1 ) * bins_ + b] = y.real () ;
+				k->im_[( p + 1 ) * bins_ + b] = y.imag () ;
+			}
+		}
+	}
+	kernel_ = std::move ( k ) ;
+}
+
+// where the spectrum of the block 'back' blocks before the newest is.
+template <typename T, size_t FFTSZ>
+size_t ProcessorConvolution<T, FFTSZ>::Slot ( size_t back ) const
+{
+	size_t const slots = kernel_->partitions_ + 1 ;
+	return ( head_ + 2 * slots - 1 - back ) % slots ;
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorConvolution<T, FFTSZ>::reset ()
+{
+	std::fill ( xre_.begin (), xre_.end (), T { 0 } ) ;
+	std::fill ( xim_.begin (), xim_.end (), T { 0 } ) ;
+	std::fill ( prev_.begin (), prev_.end (), T { 0 } ) ;
+	head_ = 0 ;
+}
+
+template <typename T, size_t FFTSZ>
+std::unique_ptr<IConvolver> ProcessorConvolution<T, FFTSZ>::clone () const
+{
+	auto p = std::make_unique<ProcessorConvolution<T, FFTSZ>> ( *this ) ;
+	p->reset () ;
+	return p ;
+}
+
+// FFTSZ samples, two blocks, a then b. Everything is read before anything is
+// written so 'in' and 'out' may be the same.
+template <typename T, size_t FFTSZ>
+void ProcessorConvolution<T, FFTSZ>::operator () ( T const* in, T* out, size_t stride )
+{
+	T const* a = in ;
+	T const* b = in + part_ * stride ;
+	for ( size_t n = 0; n < part_; ++n )
+	{
+		fftin_[n] = std::complex<T> ( prev_[n], a[n * stride] ) ;
+		fftin_[part_ + n] = std::complex<T> ( a[n * stride], b[n * stride] ) ;
+	}
+	for ( size_t n = 0; n < part_; ++n )
+		prev_[n] = b[n * stride] ;
+	fft_ ( fftin_.data (), fftout_.data ()) ;
+
+	// into the delay line, a's then b's.
+	size_t const slots = kernel_->partitions_ + 1 ;
+	T* const ar = xre_.data () + head_ * bins_ ;
+	T* const ai = xim_.data () + head_ * bins_ ;
+	head_ = ( head_ + 1 ) % slots ;
+	T* const br = xre_.data () + head_ * bins_ ;
+	T* const bi = xim_.data () + head_ * bins_ ;
+	head_ = ( head_ + 1 ) % slots ;
+	for ( size_t k = 0; k < bins_; ++k )
+	{
+		auto const [ x, y ] = split_pair<T, FFTSZ> ( fftout_.data (), k ) ;
+		ar[k] = x.real () ;
+		ai[k] = x.imag () ;
+		br[k] = y.real () ;
+		bi[k] = y.imag () ;
+	}
+
+	// a's output spectrum from partition p and the block p before a, b's from the block p before b.
+	std::fill ( y1re_.begin (), y1re_.end (), T { 0 } ) ;
+	std::fill ( y1im_.begin (), y1im_.end (), T { 0 } ) ;
+	std::fill ( y2re_.begin (), y2re_.end (), T { 0 } ) ;
+	std::fill ( y2im_.begin (), y2im_.end (), T { 0 } ) ;
+	for ( size_t p = 0; p < kernel_->partitions_; ++p )
+	{
+		T const* hr = kernel_->re_.data () + p * bins_ ;
+		T const* hi = kernel_->im_.data () + p * bins_ ;
+		T const* xar = xre_.data () + Slot ( p + 1 ) * bins_ ;
+		T const* xai = xim_.data () + Slot ( p + 1 ) * bins_ ;
+		T const* xbr = xre_.data () + Slot ( p ) * bins_ ;
+		T const* xbi = xim_.data () + Slot ( p ) * bins_ ;
+		for ( size_t k = 0; k < bins_; ++k )
+		{
+			y1re_[k] += hr[k] * xar[k] - hi[k] * xai[k] ;
+			y1im_[k] += hr[k] * xai[k] + hi[k] * xar[k] ;
+			y2re_[k] += hr[k] * xbr[k] - hi[k] * xbi[k] ;
+			y2im_[k] += hr[k] * xbi[k] + hi[k] * xbr[k] ;
+		}
+	}
+
+	// Y1 + iY2, the spectrum of a's output + i.b's, the upper half from the conjugates.
+	for ( size_t k = 0; k < bins_; ++k )
+		fftin_[k] = std::complex<T> ( y1re_[k] - y2im_[k], y1im_[k] + y2re_[k] ) ;
+	for ( size_t k = 1; k < bins_ - 1; ++k )
+		fftin_[FFTSZ - k] = std::complex<T> ( y1re_[k] + y2im_[k], y2re_[k] - y1im_[k] ) ;
+	ifft_ ( fftin_.data (), fftout_.data ()) ;
+
+	// the last half, the first wrapped round.
+	for ( size_t n = 0; n < part_; ++n )
+	{
+		out[n * stride] = fftout_[part_ + n].real () ;
+		out[( part_ + n ) * stride] = fftout_[part_ + n].imag () ;
+	}
+}
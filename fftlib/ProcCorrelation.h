@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include "FFT.h"
+
+// autocorrelation (Wiener-Khinchin) and real cepstrum, both the inverse
+// transform of a real, even function of the spectrum, |X|^2 or ln|X|.
+// Frames go two to a forward transform, as its real and imaginary parts,
+// and since the functions of their spectra are real and even the two come
+// back from one inverse transform the same way. For the autocorrelation
+// the frame is half the transform, the rest zero, so no lag wraps round.
+//
+template <typename T, size_t FFTSZ, bool Cepstrum> class ProcessorCorrelation : public IProcessorCorrelation
+{
+private :
+	// samples in, and values out, lags from 0 or the non-redundant half of the cepstrum.
+	static constexpr size_t frame_ = Cepstrum ? FFTSZ : FFTSZ / 2 ;
+	static constexpr size_t lags_  = FFTSZ / 2 ;
+
+	// working spaces
+	std::array<std::complex<T>, FFTSZ> fftin_ ;
+	std::array<std::complex<T>, FFTSZ> fftout_ ;
+
+	// processor objects
+	Window<T, frame_> window_ ;
+	FFT<T, FFTSZ>     fft_ ;
+	FFT<T, FFTSZ, -1> ifft_ ;
+
+	T Of ( std::complex<T> x ) const ;
+	void Pair ( T const* a, T const* b, T* oa, T* ob ) ;
+
+public :
+	explicit ProcessorCorrelation ( window_t wt ) ;
+	virtual void operator () ( T const* ib, size_t frames, size_t hop, T* out ) final ;
+	virtual size_t frame () final { return frame_ ; }
+	virtual size_t lags () final { return lags_ ; }
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; ifft_.Strategy ( st ) ; }
+} ;
+
+#include "ProcCorrelationImpl.h"
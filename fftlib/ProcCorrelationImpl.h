@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+template <typename T, size_t FFTSZ, bool Cepstrum>
+ProcessorCorrelation<T, FFTSZ, Cepstrum>::ProcessorCorrelation ( window_t wt ) : window_ ( wt )
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+	// the padding, never written again.
+	std::fill ( fftin_.begin () + frame_, fftin_.end (), std::complex<T> ()) ;
+}
+
+// the power spectrum, or the log magnitude, floored so silence stays finite.
+template <typename T, size_t FFTSZ, bool Cepstrum>
+T ProcessorCorrelation<T, FFTSZ, Cepstrum>::Of ( std::complex<T> x ) const
+{
+	T const p = x.real () * x.real () + x.imag () * x.imag () ;
+	if constexpr ( Cepstrum )
+		return T { 0.5 } * std::log ( std::max ( p, std::numeric_limits<T>::min ())) ;
+	else
+		return p ;
+}
+
+template <typename T, size_t FFTSZ, bool Cepstrum>
+void ProcessorCorrelation<T, FFTSZ, Cepstrum>::Pair ( T const* a, T const* b, T* oa, T* ob )
+{
+	for ( size_t n = 0; n < frame_; ++n )
+		fftin_[n] = std::complex<T> ( a[n] * window_[n], b ? b[n] * window_[n] : T { 0 } ) ;
+	fft_ ( fftin_.data (), fftout_.data ()) ;
+
+	// f(X) + i.f(Y), even, so only half of it need be worked out. In place, each
+	// pair k, N - k is read and then written and not looked at again.
+	for ( size_t k = 0; k <= FFTSZ / 2; ++k )
+	{
+		auto const [ x, y ] = split_pair<T, FFTSZ> ( fftout_.data (), k ) ;
+		fftout_[k] = fftout_[( FFTSZ - k ) & ( FFTSZ - 1 )] = std::complex<T> ( Of ( x ), Of ( y )) ;
+	}
+	ifft_ ( fftout_.data (), fftout_.data ()) ;
+	for ( size_t n = 0; n < lags_; ++n )
+		oa[n] = fftout_[n].real () ;
+	if ( b )
+	{
+		for ( size_t n = 0; n < lags_; ++n )
+			ob[n] = fftout_[n].imag () ;
+	}
+}
+
+template <typename T, size_t FFTSZ, bool Cepstrum>
+void ProcessorCorrelation<T, FFTSZ, Cepstrum>::operator () ( T const* ib, size_t frames, size_t hop, T* out )
+{
+	for ( size_t f = 0; f < frames; f += 2 )
+	{
+		T const* a = ib + f * hop ;
+		T const* b = f + 1 < frames ? a + hop : nullptr ;
+		Pair ( a, b, out + f * lags_, out + ( f + 1 ) * lags_ ) ;
+	}
+}
@@ -6,30 +6,85 @@
 
 #pragma once
 
+#include <vector>
+
+#include "Arena.h"
 #include "FFT.h"
+#include "Stats.h"
+#include "WorkspacePool.h"
 
-template <typename T, size_t FFTSZ> class ProcessorFFT : public IProcessorFFT
+// T is the precision the window, the data and the magnitudes are held in, C
+// that of the twiddles and the butterflies. Results are rounded to fp_t last.
+//
+template <typename T, size_t FFTSZ, typename C = T> class ProcessorFFT : public IProcessorFFT, public arena_object,
+	public workspace_pool<ProcessorFFT<T, FFTSZ, C>>
 {
 private :
-	// working spaces
-	std::array<T, FFTSZ>  wsp1_ ;
-	std::array<T, FFTSZ>  wsp2_ ;
-	std::array<std::complex<T>, FFTSZ> fftin_ ;
-	std::array<std::complex<T>, FFTSZ> fftout_ ;
+	friend class workspace_pool<ProcessorFFT> ;
+
+	// everything a transform writes, so the processor itself is only read by execute.
+	struct workspace_t : IFFTWorkspace, arena_object
+	{
+		// working spaces, each on a cache line.
+		alignas ( ArenaAlign ) std::array<T, FFTSZ>  wsp1_ ;
+		alignas ( ArenaAlign ) std::array<T, FFTSZ>  wsp2_ ;
+		alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftin_ ;
+		alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftout_ ;
+		alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftbuf_ ;
+		// the results when T isn't fp_t.
+		std::vector<fp_t> out_ ;
+		// the range wsp2_ was cleared for, and the scaling for the last short frame and the window it's for.
+		// Keyed by the window rather than the processor, a workspace outlives processors and is shared by them.
+		size_t      first_ ;
+		size_t      last_ ;
+		size_t      live_ ;
+		T           live_factor_ ;
+		window_t    live_window_ ;
+	} ;
 
 	// processor objects
-	Window<T, FFTSZ> window_ ;
-	FFT<T, FFTSZ>    fft_ ;
+	Window<T, FFTSZ>       window_ ;
+	FFT<T, FFTSZ, 1, C>    fft_ ;
+
+	// pruning, the bins wanted.
+	size_t first_ ;
+	size_t last_ ;
+
+	// instrumentation
+	bool        stats_on_ ;
+	fft_stats_t stats_ ;
 
 	// helper fns
-	void PrepareFFT () ;
-	void PostFFT () ;
+	static void PrepareFFT ( workspace_t& ws ) ;
+	static void PostFFT ( workspace_t& ws ) ;
+	std::unique_ptr<workspace_t> Workspace () const ;
+	template <typename S> std::pair<fp_t const*, fp_t const*> Transform ( S const* ib, S const* ie, workspace_t& ws, fft_stats_t* stats ) const ;
+	template <typename S> std::pair<fp_t const*, fp_t const*> Pruned ( S const* ib, size_t live, workspace_t& ws, fft_stats_t* stats ) const ;
+	static std::pair<fp_t const*, fp_t const*> Result ( T const* b, workspace_t& ws ) ;
 
 public :
 	ProcessorFFT ( window_t wt = window_t::HAMMING ) ;
 	virtual ~ProcessorFFT () final;
-	virtual std::pair<T const*, T const*> operator () ( T const* ib, T const* ie ) final;
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( fp_t const* ib, fp_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( int16_t const* ib, int16_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( pcm24_t const* ib, pcm24_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( int32_t const* ib, int32_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
 	virtual size_t width () final { return FFTSZ ; } 
+	virtual void prune ( size_t first, size_t last ) final ;
+	virtual void enable_stats ( bool enable ) final ;
+	virtual fft_stats_t stats () const final { return stats_ ; }
+	virtual std::unique_ptr<IFFTWorkspace> make_workspace () const final { return Workspace () ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( fp_t const* ib, fp_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( int16_t const* ib, int16_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( pcm24_t const* ib, pcm24_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( int32_t const* ib, int32_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual void execute ( fp_t const* ib, fp_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	virtual void execute ( int16_t const* ib, int16_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	virtual void execute ( pcm24_t const* ib, pcm24_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	virtual void execute ( int32_t const* ib, int32_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; }
+	// whether the strategy changes a full frame's transform, so there's something to measure.
+	static constexpr bool Measurable () { return !FFT<T, FFTSZ, 1, C>::HasCodelets () ; }
 } ;
 
 #include "ProcFFTImpl.h"
\ No newline at end of file
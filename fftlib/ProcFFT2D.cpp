@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <complex>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <bit>
+
+#include "fftlib.h"
+
+#include "FFTCore.h"
+#include "ProcFFT2D.h"
+#include "Parallel.h"
+
+namespace
+{
+	// square tiles of this many complex values a side, small enough that a source
+	// and a destination tile both stay in L1 while the tile is transposed.
+	const size_t TransposeTile = 32;
+
+	// less work than this per worker isn't worth a thread.
+	const size_t MinPointsPerWorker = 65536;
+
+	// dst (cols x rows) = transpose of src (rows x cols), both row major.
+	void transpose(std::complex<fp_t> const* src, std::complex<fp_t>* dst, size_t rows, size_t cols)
+	{
+		size_t const row_tiles = (rows + TransposeTile - 1) / TransposeTile;
+		parallel_for(row_tiles, std::max<size_t>(1, MinPointsPerWorker / (TransposeTile * cols)), [=](size_t tb, size_t te)
+			{
+				for (size_t r0 = tb * TransposeTile; r0 < std::min(rows, te * TransposeTile); r0 += TransposeTile)
+				{
+					size_t const r1 = std::min(rows, r0 + TransposeTile);
+					for (size_t c0 = 0; c0 < cols; c0 += TransposeTile)
+					{
+						size_t const c1 = std::min(cols, c0 + TransposeTile);
+						for (size_t r = r0; r < r1; ++r)
+							for (size_t c = c0; c < c1; ++c)
+								dst[c * rows + r] = src[r * cols + c];
+					}
+				}
+			});
+	}
+}
+
+ProcessorFFT2D::ProcessorFFT2D(size_t rows_width, size_t cols_width) : rows_(size_t(1) << rows_width), cols_(size_t(1) << cols_width),
+	wsp1_(rows_ * cols_), wsp2_(rows_ * cols_)
+{
+	size_t const hw = std::max<size_t>(1, std::thread::hardware_concurrency());
+	workers_.resize(std::clamp<size_t>(rows_ * cols_ / MinPointsPerWorker, 1, hw));
+	for (auto& w : workers_)
+	{
+		w.row_ = make_fft_core(cols_width, 1);
+		w.col_ = make_fft_core(rows_width, 1);
+		w.pack_.resize(cols_);
+		w.packed_.resize(cols_);
+	}
+}
+
+// share [0, rows) out between the workers, fn ( worker, b, e ).
+template <typename F> void ProcessorFFT2D::ForRows(size_t rows, F fn)
+{
+	size_t const n = workers_.size();
+	parallel_for(n, 1, [&](size_t b, size_t e)
+		{
+			for (size_t i = b; i < e; ++i)
+				fn(workers_[i], i * rows / n, (i + 1) * rows / n);
+		});
+}
+
+// transform the first ncols columns of rows_ x ncols, in place.
+void ProcessorFFT2D::Columns(std::complex<fp_t>* inout, size_t ncols)
+{
+	transpose(inout, wsp1_.data(), rows_, ncols);
+	ForRows(ncols, [this](worker_t& w, size_t b, size_t e)
+		{
+			for (size_t c = b; c < e; ++c)
+				(*w.col_) (wsp1_.data() + c * rows_, wsp2_.data() + c * rows_);
+		});
+	transpose(wsp2_.data(), inout, ncols, rows_);
+}
+
+void ProcessorFFT2D::operator () (std::complex<fp_t> const* in, std::complex<fp_t>* out)
+{
+	ForRows(rows_, [=, this](worker_t& w, size_t b, size_t e)
+		{
+			for (size_t r = b; r < e; ++r)
+				(*w.row_) (in + r * cols_, out + r * cols_);
+		});
+	Columns(out, cols_);
+}
+
+// real rows are transformed in pairs, one as the real part and one as the imaginary
+// part of a single complex transform, then separated using the conjugate symmetry
+// of the spectrum of a real sequence. Only the cols / 2 + 1 columns that aren't
+// redundant are kept, and only they are transformed as columns.
+//
+void ProcessorFFT2D::operator () (fp_t const* in, std::complex<fp_t>* out)
+{
+	size_t const half = cols_ / 2 + 1;
+	ForRows(rows_ / 2, [=, this](worker_t& w, size_t b, size_t e)
+		{
+			for (size_t p = b; p < e; ++p)
+			{
+				fp_t const* x = in + 2 * p * cols_;
+				fp_t const* y = x + cols_;
+				for (size_t n = 0; n < cols_; ++n)
+					w.pack_[n] = std::complex<fp_t>(x[n], y[n]);
+				(*w.row_) (w.pack_.data(), w.packed_.data());
+
+				std::complex<fp_t>* X = out + 2 * p * half;
+				std::complex<fp_t>* Y = X + half;
+				for (size_t k = 0; k < half; ++k)
+				{
+					auto const z  = w.packed_[k];
+					auto const zc = std::conj(w.packed_[(cols_ - k) & (cols_ - 1)]);
+					X[k] = (z + zc) * fp_t(0.5);
+					Y[k] = (z - zc) * std::complex<fp_t>(0, fp_t(-0.5));
+				}
+			}
+		});
+	Columns(out, half);
+}
+
+std::unique_ptr<IProcessorFFT2D> make_fft2d(size_t rows_width, size_t cols_width)
+{
+	if (rows_width < FFTWdMin || rows_width > FFTWdMax || cols_width < FFTWdMin || cols_width > FFTWdMax)
+		return std::unique_ptr<IProcessorFFT2D>();
+	return std::make_unique<ProcessorFFT2D>(rows_width, cols_width);
+}
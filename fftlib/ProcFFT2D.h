@@ -0,0 +1,46 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "FFTCore.h"
+
+// row-column 2D transform. Rows are transformed in place, the result is
+// transposed in cache sized tiles so the columns become contiguous rows,
+// those are transformed and the result transposed back. Rows are shared
+// out between workers, each with its own transforms and scratch.
+//
+class ProcessorFFT2D : public IProcessorFFT2D
+{
+private :
+	struct worker_t
+	{
+		std::unique_ptr<IFFTCore<fp_t>> row_ ;
+		std::unique_ptr<IFFTCore<fp_t>> col_ ;
+		std::vector<std::complex<fp_t>> pack_ ;
+		std::vector<std::complex<fp_t>> packed_ ;
+	} ;
+
+	size_t rows_ ;
+	size_t cols_ ;
+	std::vector<worker_t> workers_ ;
+
+	// working spaces, the transposed data.
+	std::vector<std::complex<fp_t>> wsp1_ ;
+	std::vector<std::complex<fp_t>> wsp2_ ;
+
+	template <typename F> void ForRows ( size_t rows, F fn ) ;
+	void Columns ( std::complex<fp_t> * inout, size_t ncols ) ;
+
+public :
+	ProcessorFFT2D ( size_t row_width, size_t col_width ) ;
+	virtual void operator () ( std::complex<fp_t> const* in, std::complex<fp_t> * out ) final ;
+	virtual void operator () ( fp_t const* in, std::complex<fp_t> * out ) final ;
+	virtual size_t rows () final { return rows_ ; }
+	virtual size_t cols () final { return cols_ ; }
+} ;
@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include "FFT.h"
+
+// Welch averaged auto and cross spectra of two real channels. Each frame
+// of both channels is transformed at once, x as the real part and y as the
+// imaginary part of one complex transform, and the spectra separated again.
+// Accumulates in double, the averages can run for a long time.
+//
+template <typename T, size_t FFTSZ> class ProcessorCrossFFT : public IProcessorCrossFFT
+{
+private :
+	// working spaces
+	std::array<std::complex<T>, FFTSZ> fftin_ ;
+	std::array<std::complex<T>, FFTSZ> fftout_ ;
+
+	// accumulated, for bins [0, FFTSZ/2)
+	std::array<double, FFTSZ / 2> gxx_ ;
+	std::array<double, FFTSZ / 2> gyy_ ;
+	std::array<std::complex<double>, FFTSZ / 2> gxy_ ;
+	size_t frames_ ;
+
+	// processor objects
+	Window<T, FFTSZ> window_ ;
+	FFT<T, FFTSZ>    fft_ ;
+
+	// scale so that the square root of an auto spectrum is the magnitude ProcessorFFT gives.
+	double Scale () const ;
+
+public :
+	ProcessorCrossFFT ( window_t wt ) ;
+	virtual void operator () ( T const* xb, T const* yb, size_t stride ) final ;
+	virtual void reset () final ;
+	virtual size_t frames () final { return frames_ ; }
+	virtual size_t width () final { return FFTSZ ; }
+	virtual void auto_spectra ( T* gxx, T* gyy ) final ;
+	virtual void cross_spectrum ( std::complex<T>* gxy ) final ;
+	virtual void h1 ( std::complex<T>* h ) final ;
+	virtual void h2 ( std::complex<T>* h ) final ;
+	virtual void coherence ( T* c ) final ;
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; }
+} ;
+
+#include "ProcFFTCrossImpl.h"
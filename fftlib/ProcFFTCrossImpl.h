@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+template <typename T, size_t FFTSZ>
+ProcessorCrossFFT<T, FFTSZ>::ProcessorCrossFFT ( window_t wt ) : window_ ( wt )
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+	reset () ;
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::reset ()
+{
+	gxx_.fill ( 0.0 ) ;
+	gyy_.fill ( 0.0 ) ;
+	gxy_.fill ( std::complex<double> {} ) ;
+	frames_ = 0 ;
+}
+
+template <typename T, size_t FFTSZ>
+double ProcessorCrossFFT<T, FFTSZ>::Scale () const
+{
+	double const s = 2.0 * window_.Gain () / FFTSZ ;
+	return s * s / static_cast<double>( std::max<size_t> ( frames_, 1 )) ;
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::operator () ( T const* xb, T const* yb, size_t stride )
+{
+	for ( size_t n = 0; n < FFTSZ; ++n )
+		fftin_[n] = std::complex<T> ( xb[n * stride] * window_[n], yb[n * stride] * window_[n] ) ;
+	fft_ ( fftin_.data (), fftout_.data ()) ;
+
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+	{
+		auto const [ x, y ] = split_pair<T, FFTSZ> ( fftout_.data (), k ) ;
+		std::complex<double> const xd ( x ) ;
+		std::complex<double> const yd ( y ) ;
+		gxx_[k] += std::norm ( xd ) ;
+		gyy_[k] += std::norm ( yd ) ;
+		gxy_[k] += std::conj ( xd ) * yd ;
+	}
+	++frames_ ;
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::auto_spectra ( T* gxx, T* gyy )
+{
+	double const s = Scale () ;
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+	{
+		gxx[k] = static_cast<T>( gxx_[k] * s ) ;
+		gyy[k] = static_cast<T>( gyy_[k] * s ) ;
+	}
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::cross_spectrum ( std::complex<T>* gxy )
+{
+	double const s = Scale () ;
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+		gxy[k] = std::complex<T> ( gxy_[k] * s ) ;
+}
+
+// H1 = Gxy / Gxx, the least squares estimate with the noise on y.
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::h1 ( std::complex<T>* h )
+{
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+		h[k] = gxx_[k] > 0 ? std::complex<T> ( gxy_[k] / gxx_[k] ) : std::complex<T> {} ;
+}
+
+// H2 = Gyy / Gyx, with the noise on x.
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::h2 ( std::complex<T>* h )
+{
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+		h[k] = std::norm ( gxy_[k] ) > 0 ? std::complex<T> ( gyy_[k] / std::conj ( gxy_[k] )) : std::complex<T> {} ;
+}
+
+// |Gxy|^2 / ( Gxx Gyy ), 1 for a noiseless linear system. Needs several frames to mean anything.
+template <typename T, size_t FFTSZ>
+void ProcessorCrossFFT<T, FFTSZ>::coherence ( T* c )
+{
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+	{
+		double const d = gxx_[k] * gyy_[k] ;
+		c[k] = d > 0 ? static_cast<T>( std::norm ( gxy_[k] ) / d ) : T { 0 } ;
+	}
+}
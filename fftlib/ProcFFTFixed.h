@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include "Arena.h"
+#include "FFTFixed.h"
+#include "Stats.h"
+#include "WorkspacePool.h"
+
+// ProcessorFFT over FFTFixed. The frame is windowed in fp_t, scaled by a power
+// of 2 so its largest sample is near full scale and rounded to Q15, then
+// transformed in block floating point, and the magnitudes are taken in fp_t
+// with the block's exponent and the window's gain applied together.
+// Pruning only narrows the bins whose magnitudes are taken, the butterflies all run.
+//
+template <size_t FFTSZ> class ProcessorFFTFixed : public IProcessorFFT, public arena_object,
+	public workspace_pool<ProcessorFFTFixed<FFTSZ>>
+{
+private :
+	friend class workspace_pool<ProcessorFFTFixed> ;
+
+	// everything a transform writes, so the processor itself is only read by execute.
+	struct workspace_t : IFFTWorkspace, arena_object
+	{
+		// working spaces, each on a cache line.
+		alignas ( ArenaAlign ) std::array<fp_t, FFTSZ>  wsp1_ ;
+		alignas ( ArenaAlign ) std::array<fp_t, FFTSZ>  wsp2_ ;
+		// planar, as FFTFixed.
+		alignas ( ArenaAlign ) std::array<fixed_t, 2 * FFTSZ> fftin_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, 2 * FFTSZ> fftout_ ;
+		alignas ( ArenaAlign ) std::array<fixed_t, 2 * FFTSZ> fftbuf_ ;
+		// the range wsp2_ was cleared for, and the scaling for the last short frame and the window it's for.
+		// Keyed by the window rather than the processor, a workspace outlives processors and is shared by them.
+		size_t      first_ ;
+		size_t      last_ ;
+		size_t      live_ ;
+		fp_t        live_factor_ ;
+		window_t    live_window_ ;
+	} ;
+
+	// processor objects
+	Window<fp_t, FFTSZ> window_ ;
+	FFTFixed<FFTSZ>     fft_ ;
+
+	// pruning, the bins wanted.
+	size_t first_ ;
+	size_t last_ ;
+
+	// instrumentation
+	bool        stats_on_ ;
+	fft_stats_t stats_ ;
+
+	// helper fns
+	std::unique_ptr<workspace_t> Workspace () const ;
+	template <typename S> std::pair<fp_t const*, fp_t const*> Transform ( S const* ib, S const* ie, workspace_t& ws, fft_stats_t* stats ) const ;
+	static int Quantise ( workspace_t& ws ) ;
+
+public :
+	ProcessorFFTFixed ( window_t wt = window_t::HAMMING ) ;
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( fp_t const* ib, fp_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( int16_t const* ib, int16_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( pcm24_t const* ib, pcm24_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( int32_t const* ib, int32_t const* ie ) final { return this->Own ( ib, ie, stats_on_ ? &stats_ : nullptr ) ; }
+	virtual size_t width () final { return FFTSZ ; }
+	virtual void prune ( size_t first, size_t last ) final ;
+	virtual void enable_stats ( bool enable ) final ;
+	virtual fft_stats_t stats () const final { return stats_ ; }
+	virtual std::unique_ptr<IFFTWorkspace> make_workspace () const final { return Workspace () ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( fp_t const* ib, fp_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( int16_t const* ib, int16_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( pcm24_t const* ib, pcm24_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual std::pair<fp_t const*, fp_t const*> execute ( int32_t const* ib, int32_t const* ie, IFFTWorkspace& ws ) const final { return this->Execute ( ib, ie, ws ) ; }
+	virtual void execute ( fp_t const* ib, fp_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	virtual void execute ( int16_t const* ib, int16_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	virtual void execute ( pcm24_t const* ib, pcm24_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+	virtual void execute ( int32_t const* ib, int32_t const* ie, fp_t* out ) const final { this->Pooled ( ib, ie, out ) ; }
+} ;
+
+#include "ProcFFTFixedImpl.h"
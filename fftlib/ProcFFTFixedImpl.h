@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+template <size_t FFTSZ>
+ProcessorFFTFixed<FFTSZ>::ProcessorFFTFixed ( window_t wt ) : window_ ( wt ), first_ ( 0 ), last_ ( FFTSZ / 2 ),
+	stats_on_ ( false ), stats_ {}
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+}
+
+template <size_t FFTSZ>
+std::unique_ptr<typename ProcessorFFTFixed<FFTSZ>::workspace_t> ProcessorFFTFixed<FFTSZ>::Workspace () const
+{
+	// wsp1_, the real half of fftin_, fftout_ and fftbuf_ are written before they're read, so aren't
+	// zeroed. wsp2_ is, only the bins in range are written and those outside it have to read 0.
+	auto ws = std::make_unique_for_overwrite<workspace_t> () ;
+	std::fill ( ws->wsp2_.begin (), ws->wsp2_.end (), fp_t { 0 } ) ;
+	// the input is real, its imaginary parts are never written.
+	std::fill ( ws->fftin_.begin () + FFTSZ, ws->fftin_.end (), fixed_t { 0 } ) ;
+	ws->first_ = 0 ;
+	ws->last_ = FFTSZ / 2 ;
+	ws->live_ = 0 ;
+	ws->live_factor_ = 0 ;
+	ws->live_window_ = window_t::NOWINDOW ;
+	return ws ;
+}
+
+template <size_t FFTSZ>
+void ProcessorFFTFixed<FFTSZ>::enable_stats ( bool enable )
+{
+	stats_on_ = enable ;
+	stats_ = fft_stats_t {} ;
+}
+
+template <size_t FFTSZ>
+void ProcessorFFTFixed<FFTSZ>::prune ( size_t first, size_t last )
+{
+	last_  = std::min ( last, FFTSZ / 2 ) ;
+	first_ = std::min ( first, last_ ) ;
+}
+
+// the windowed frame in wsp1_ to Q15 in fftin_, times 2^q so the largest sample is between half and full
+// scale, q returned. A silent frame is left silent.
+template <size_t FFTSZ>
+int ProcessorFFTFixed<FFTSZ>::Quantise ( workspace_t& ws )
+{
+	fp_t peak = 0 ;
+	for ( fp_t x : ws.wsp1_ )
+		peak = std::max ( peak, std::abs ( x )) ;
+	int ex = 0 ;
+	std::frexp ( peak, &ex ) ;
+	// fp_t's exponent range, and a peak of 0 leaves ex 0.
+	int const q = std::clamp ( 15 - ex, -120, 120 ) ;
+	fp_t const scale = std::ldexp ( fp_t { 1 }, q ) ;
+	std::transform ( ws.wsp1_.begin (), ws.wsp1_.end (), ws.fftin_.begin (), [ scale ] ( fp_t x )
+		{
+			return static_cast<fixed_t>( std::clamp ( static_cast<int32_t>( x * scale + std::copysign ( fp_t { 0.5 }, x )), -32768, 32767 )) ;
+		}) ;
+	return q ;
+}
+
+// a short frame's window is sampled at the centre of each of 'live' equal parts and the scaling
+// follows from its sum, as ProcessorFFT's.
+//
+template <size_t FFTSZ>
+template <typename S> std::pair<fp_t const*, fp_t const*> ProcessorFFTFixed<FFTSZ>::Transform ( S const* ib, S const* ie, workspace_t& ws, fft_stats_t* stats ) const
+{
+	size_t const live = std::min<size_t> ( ie - ib, FFTSZ ) ;
+	// the times go nowhere without stats.
+	fft_stats_t none {} ;
+	fft_stats_t& st = stats ? *stats : none ;
+	phase_timer pt ( stats != nullptr ) ;
+	fp_t factor ;
+	if ( live == FFTSZ )
+	{
+		window_ ( ib, ie, ws.wsp1_.begin ()) ;
+		factor = window_.Gain () * fp_t { 2 } / FFTSZ ;
+	}
+	else
+	{
+		auto coeff = [ live ] ( size_t n ) { return ( 2 * n + 1 ) * FFTSZ / ( 2 * live ) ; } ;
+		if ( live != ws.live_ || ws.live_window_ != window_.Type ())
+		{
+			double sum = 0 ;
+			for ( size_t n = 0; n < live; ++n )
+				sum += window_[coeff ( n )] ;
+			ws.live_ = live ;
+			ws.live_factor_ = static_cast<fp_t>( 2.0 / sum ) ;
+			ws.live_window_ = window_.Type () ;
+		}
+		for ( size_t n = 0; n < live; ++n )
+			ws.wsp1_[n] = sample_value<fp_t> ( ib[n] ) * window_[coeff ( n )] ;
+		std::fill ( ws.wsp1_.begin () + live, ws.wsp1_.end (), fp_t { 0 } ) ;
+		factor = ws.live_factor_ ;
+	}
+	int const q = Quantise ( ws ) ;
+	pt.lap ( st.window_ns ) ;
+	int const e = fft_ ( ws.fftin_.data (), ws.fftout_.data (), ws.fftbuf_.data ()) ;
+	pt.lap ( st.fft_ns ) ;
+
+	if ( ws.first_ != first_ || ws.last_ != last_ )
+	{
+		// only the range is written from now on.
+		std::fill ( ws.wsp2_.begin (), ws.wsp2_.end (), fp_t { 0 } ) ;
+		ws.first_ = first_ ;
+		ws.last_ = last_ ;
+	}
+	fp_t const scale = std::ldexp ( factor * fp_t ( sample_scale_v<S> ), e - q ) ;
+	for ( size_t j = first_; j < last_; ++j )
+	{
+		fp_t const re = ws.fftout_[j] ;
+		fp_t const im = ws.fftout_[FFTSZ + j] ;
+		ws.wsp2_[j] = std::sqrt ( re * re + im * im ) * scale ;
+	}
+	pt.lap ( st.magnitude_ns ) ;
+
+	if ( stats )
+	{
+		++stats->frames ;
+		stats->bytes += live * sizeof ( S ) ;
+	}
+	return std::make_pair ( ws.wsp2_.data (), ws.wsp2_.data () + FFTSZ / 2 ) ;
+}
@@ -4,39 +4,145 @@
 // Refer to licence in repository.
 //
 
-template <typename T, size_t FFTSZ>
-void ProcessorFFT<T, FFTSZ>::PrepareFFT ()
+template <typename T, size_t FFTSZ, typename C>
+void ProcessorFFT<T, FFTSZ, C>::PrepareFFT ( workspace_t& ws )
 {
-	std::copy(wsp1_.begin(), wsp1_.end(), fftin_.begin());
+	std::copy(ws.wsp1_.begin(), ws.wsp1_.end(), ws.fftin_.begin());
 }
 
-template <typename T, size_t FFTSZ>
-void ProcessorFFT<T, FFTSZ>::PostFFT ()
+template <typename T, size_t FFTSZ, typename C>
+void ProcessorFFT<T, FFTSZ, C>::PostFFT ( workspace_t& ws )
 {
 	// taking the magnitude of each FFT output point
-	std::transform ( fftout_, fftout_ + FFTSZ / 2, wsp2_, std::norm<T> ) ;
+	std::transform ( ws.fftout_.begin (), ws.fftout_.begin () + FFTSZ / 2, ws.wsp2_.begin (), std::norm<T> ) ;
 }
 
-template <typename T, size_t FFTSZ>
-ProcessorFFT<T, FFTSZ>::ProcessorFFT ( window_t wt ) : window_ ( wt )
+template <typename T, size_t FFTSZ, typename C>
+ProcessorFFT<T, FFTSZ, C>::ProcessorFFT ( window_t wt ) : window_ ( wt ), first_ ( 0 ), last_ ( FFTSZ / 2 ),
+	stats_on_ ( false ), stats_ {}
 {
 	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
 }
 
-template <typename T, size_t FFTSZ>
-ProcessorFFT<T, FFTSZ>::~ProcessorFFT ()
+template <typename T, size_t FFTSZ, typename C>
+std::unique_ptr<typename ProcessorFFT<T, FFTSZ, C>::workspace_t> ProcessorFFT<T, FFTSZ, C>::Workspace () const
 {
+	// wsp1_ and the transform's arrays are written before they're read, so aren't zeroed. wsp2_ is,
+	// a pruned transform only writes the bins in range and those outside it have to read 0.
+	auto ws = std::make_unique_for_overwrite<workspace_t> () ;
+	if constexpr ( !std::is_same_v<T, fp_t> )
+		ws->out_.resize ( FFTSZ / 2 ) ;
+	std::fill ( ws->wsp2_.begin (), ws->wsp2_.end (), T { 0 } ) ;
+	ws->first_ = 0 ;
+	ws->last_ = FFTSZ / 2 ;
+	ws->live_ = 0 ;
+	ws->live_factor_ = 0 ;
+	ws->live_window_ = window_t::NOWINDOW ;
+	return ws ;
 }
 
-template <typename T, size_t FFTSZ>
-std::pair<T const*, T const*> ProcessorFFT<T, FFTSZ>::operator () ( T const* ib, T const* ie )
+// the magnitudes at 'b', rounded to fp_t if need be.
+template <typename T, size_t FFTSZ, typename C>
+std::pair<fp_t const*, fp_t const*> ProcessorFFT<T, FFTSZ, C>::Result ( T const* b, workspace_t& ws )
 {
-	window_ ( ib, ie, wsp1_.begin() ) ;
-	PrepareFFT () ;
-	fft_ ( fftin_.data(), fftout_.data());
+	if constexpr ( std::is_same_v<T, fp_t> )
+		return std::make_pair ( b, b + FFTSZ / 2 ) ;
+	else
+	{
+		std::transform ( b, b + FFTSZ / 2, ws.out_.begin (), [] ( T t ) { return static_cast<fp_t>( t ) ; }) ;
+		return std::make_pair ( ws.out_.data (), ws.out_.data () + ws.out_.size ()) ;
+	}
+}
+
+template <typename T, size_t FFTSZ, typename C>
+ProcessorFFT<T, FFTSZ, C>::~ProcessorFFT ()
+{
+}
+
+template <typename T, size_t FFTSZ, typename C>
+void ProcessorFFT<T, FFTSZ, C>::enable_stats ( bool enable )
+{
+	stats_on_ = enable ;
+	stats_ = fft_stats_t {} ;
+}
+
+template <typename T, size_t FFTSZ, typename C>
+void ProcessorFFT<T, FFTSZ, C>::prune ( size_t first, size_t last )
+{
+	last_  = std::min ( last, FFTSZ / 2 ) ;
+	first_ = std::min ( first, last_ ) ;
+}
+
+// the window is sampled at the centre of each of 'live' equal parts, and the scaling follows
+// from its sum, so a sine of amplitude A still reads A however short the frame.
+//
+template <typename T, size_t FFTSZ, typename C>
+template <typename S> std::pair<fp_t const*, fp_t const*> ProcessorFFT<T, FFTSZ, C>::Pruned ( S const* ib, size_t live, workspace_t& ws, fft_stats_t* stats ) const
+{
+	auto coeff = [ live ] ( size_t n ) { return ( 2 * n + 1 ) * FFTSZ / ( 2 * live ) ; } ;
+	// the times go nowhere without stats.
+	fft_stats_t none {} ;
+	fft_stats_t& st = stats ? *stats : none ;
+	phase_timer pt ( stats != nullptr ) ;
+	if ( ws.first_ != first_ || ws.last_ != last_ )
+	{
+		// only the range is written from now on.
+		std::fill ( ws.wsp2_.begin (), ws.wsp2_.end (), T { 0 } ) ;
+		ws.first_ = first_ ;
+		ws.last_ = last_ ;
+	}
+	if ( live != ws.live_ || ws.live_window_ != window_.Type ())
+	{
+		double sum = 0 ;
+		for ( size_t n = 0; n < live; ++n )
+			sum += window_[coeff ( n )] ;
+		ws.live_ = live ;
+		ws.live_factor_ = static_cast<T>( 2.0 / sum ) ;
+		ws.live_window_ = window_.Type () ;
+	}
+	for ( size_t n = 0; n < live; ++n )
+		ws.fftin_[n] = std::complex<T> ( sample_value<T> ( ib[n] ) * window_[coeff ( n )], T { 0 } ) ;
+	pt.lap ( st.window_ns ) ;
+	fft_ ( ws.fftin_.data (), ws.fftout_.data (), live, first_, last_ - first_, ws.fftbuf_.data ()) ;
+	pt.lap ( st.fft_ns ) ;
+	std::transform ( ws.fftout_.begin () + first_, ws.fftout_.begin () + last_, ws.wsp2_.begin () + first_, [ factor = ws.live_factor_ * T ( sample_scale_v<S> ) ] ( auto t ) { return std::abs<T>( t ) * factor ; } ) ;
+
+	pt.lap ( st.magnitude_ns ) ;
+
+	if ( stats )
+	{
+		++stats->frames ;
+		stats->bytes += live * sizeof ( S ) ;
+	}
+	return Result ( ws.wsp2_.data (), ws ) ;
+}
+
+template <typename T, size_t FFTSZ, typename C>
+template <typename S> std::pair<fp_t const*, fp_t const*> ProcessorFFT<T, FFTSZ, C>::Transform ( S const* ib, S const* ie, workspace_t& ws, fft_stats_t* stats ) const
+{
+	size_t const live = std::min<size_t> ( ie - ib, FFTSZ ) ;
+	if ( live < FFTSZ || first_ != 0 || last_ != FFTSZ / 2 )
+		return Pruned ( ib, live, ws, stats ) ;
+
+	// the times go nowhere without stats.
+	fft_stats_t none {} ;
+	fft_stats_t& st = stats ? *stats : none ;
+	phase_timer pt ( stats != nullptr ) ;
+	window_ ( ib, ie, ws.wsp1_.begin() ) ;
+	PrepareFFT ( ws ) ;
+	pt.lap ( st.window_ns ) ;
+	fft_ ( ws.fftin_.data(), ws.fftout_.data(), ws.fftbuf_.data() );
+	pt.lap ( st.fft_ns ) ;
 
 	// taking the magnitude of each FFT output point
-	std::transform(fftout_.begin(), fftout_.begin() + FFTSZ / 2, wsp1_.begin(), [factor = window_.Gain()](auto t) { return std::abs<T>(t) * T { 2.0 } * factor / FFTSZ; });
-	
-	return std::make_pair(wsp1_.data(), wsp1_.data() + FFTSZ / 2);
+	std::transform(ws.fftout_.begin(), ws.fftout_.begin() + FFTSZ / 2, ws.wsp1_.begin(), [factor = window_.Gain() * T ( sample_scale_v<S> )](auto t) { return std::abs<T>(t) * T { 2.0 } * factor / FFTSZ; });
+
+	pt.lap ( st.magnitude_ns ) ;
+
+	if ( stats )
+	{
+		++stats->frames ;
+		stats->bytes += ( ie - ib ) * sizeof ( S ) ;
+	}
+	return Result ( ws.wsp1_.data (), ws ) ;
 }
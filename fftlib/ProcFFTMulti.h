@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "Arena.h"
+#include "FFT.h"
+#include "Stats.h"
+
+// magnitude spectra of each channel of interleaved input. The channels are
+// de-interleaved and windowed in one pass, straight into the transform input,
+// two channels to a transform, one as the real part and one as the imaginary.
+//
+template <typename T, size_t FFTSZ> class ProcessorFFTMulti : public IProcessorFFTMulti, public arena_object
+{
+private :
+	size_t const channels_ ;
+	size_t const stride_ ;
+
+	// working spaces
+	alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftin_ ;
+	alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftout_ ;
+	std::vector<T> out_ ;
+
+	// processor objects
+	Window<T, FFTSZ> window_ ;
+	FFT<T, FFTSZ>    fft_ ;
+
+	// instrumentation
+	bool        stats_on_ ;
+	fft_stats_t stats_ ;
+
+	// helper fns
+	template <typename S> void LoadPair ( S const* ib, size_t c ) ;
+	template <typename S> void LoadOne ( S const* ib, size_t c ) ;
+	void SplitPair ( T* xo, T* yo, T scale ) const ;
+	template <typename S> std::pair<T const*, T const*> Transform ( S const* ib, S const* ie ) ;
+
+public :
+	ProcessorFFTMulti ( window_t wt, size_t channels, size_t stride ) ;
+	virtual std::pair<T const*, T const*> operator () ( T const* ib, T const* ie ) final { return Transform ( ib, ie ) ; }
+	virtual std::pair<T const*, T const*> operator () ( int16_t const* ib, int16_t const* ie ) final { return Transform ( ib, ie ) ; }
+	virtual std::pair<T const*, T const*> operator () ( pcm24_t const* ib, pcm24_t const* ie ) final { return Transform ( ib, ie ) ; }
+	virtual std::pair<T const*, T const*> operator () ( int32_t const* ib, int32_t const* ie ) final { return Transform ( ib, ie ) ; }
+	virtual size_t width () final { return FFTSZ ; }
+	virtual size_t channels () final { return channels_ ; }
+	virtual size_t stride () final { return stride_ ; }
+	virtual void enable_stats ( bool enable ) final ;
+	virtual fft_stats_t stats () const final { return stats_ ; }
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; }
+} ;
+
+#include "ProcFFTMultiImpl.h"
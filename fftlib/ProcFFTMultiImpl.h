@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+template <typename T, size_t FFTSZ>
+ProcessorFFTMulti<T, FFTSZ>::ProcessorFFTMulti ( window_t wt, size_t channels, size_t stride ) :
+	channels_ ( channels ), stride_ ( stride ), out_ ( channels * FFTSZ / 2 ), window_ ( wt ), stats_on_ ( false ), stats_ {}
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+}
+
+template <typename T, size_t FFTSZ>
+void ProcessorFFTMulti<T, FFTSZ>::enable_stats ( bool enable )
+{
+	stats_on_ = enable ;
+	stats_ = fft_stats_t {} ;
+}
+
+// channels c and c + 1, windowed, as the real and imaginary parts of the transform input.
+template <typename T, size_t FFTSZ>
+template <typename S> void ProcessorFFTMulti<T, FFTSZ>::LoadPair ( S const* ib, size_t c )
+{
+	S const* s = ib + c ;
+	for ( size_t n = 0; n < FFTSZ; ++n, s += stride_ )
+		fftin_[n] = std::complex<T> ( sample_value<T> ( s[0] ) * window_[n], sample_value<T> ( s[1] ) * window_[n] ) ;
+}
+
+template <typename T, size_t FFTSZ>
+template <typename S> void ProcessorFFTMulti<T, FFTSZ>::LoadOne ( S const* ib, size_t c )
+{
+	S const* s = ib + c ;
+	for ( size_t n = 0; n < FFTSZ; ++n, s += stride_ )
+		fftin_[n] = std::complex<T> ( sample_value<T> ( s[0] ) * window_[n], T { 0 } ) ;
+}
+
+// the two spectra as scaled magnitudes, the same as ProcessorFFT gives.
+template <typename T, size_t FFTSZ>
+void ProcessorFFTMulti<T, FFTSZ>::SplitPair ( T* xo, T* yo, T scale ) const
+{
+	T const factor = T { 2.0 } * window_.Gain () * scale / FFTSZ ;
+	for ( size_t k = 0; k < FFTSZ / 2; ++k )
+	{
+		auto const [ x, y ] = split_pair<T, FFTSZ> ( fftout_.data (), k ) ;
+		xo[k] = std::abs ( x ) * factor ;
+		yo[k] = std::abs ( y ) * factor ;
+	}
+}
+
+template <typename T, size_t FFTSZ>
+template <typename S> std::pair<T const*, T const*> ProcessorFFTMulti<T, FFTSZ>::Transform ( S const* ib, S const* ie )
+{
+	T const scale = T ( sample_scale_v<S> ) ;
+	phase_timer pt ( stats_on_ ) ;
+	size_t c = 0 ;
+	for ( ; c + 1 < channels_; c += 2 )
+	{
+		LoadPair ( ib, c ) ;
+		pt.lap ( stats_.window_ns ) ;
+		fft_ ( fftin_.data (), fftout_.data ()) ;
+		pt.lap ( stats_.fft_ns ) ;
+		SplitPair ( out_.data () + c * FFTSZ / 2, out_.data () + ( c + 1 ) * FFTSZ / 2, scale ) ;
+		pt.lap ( stats_.magnitude_ns ) ;
+	}
+	if ( c < channels_ )
+	{
+		LoadOne ( ib, c ) ;
+		pt.lap ( stats_.window_ns ) ;
+		fft_ ( fftin_.data (), fftout_.data ()) ;
+		pt.lap ( stats_.fft_ns ) ;
+		std::transform ( fftout_.begin (), fftout_.begin () + FFTSZ / 2, out_.begin () + c * FFTSZ / 2,
+			[ factor = window_.Gain () * scale ] ( auto t ) { return std::abs<T> ( t ) * T { 2.0 } * factor / FFTSZ ; }) ;
+		pt.lap ( stats_.magnitude_ns ) ;
+	}
+	if ( stats_on_ )
+	{
+		stats_.frames += channels_ ;
+		stats_.bytes += ( ie - ib ) * sizeof ( S ) ;
+	}
+	return std::make_pair ( out_.data (), out_.data () + out_.size ()) ;
+}
@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "FFT.h"
+
+// zoom FFT. The band around 'centre' is mixed to 0Hz, low pass filtered and
+// decimated, and the result transformed. Mixing is folded into the filter,
+// g[j] = h[j].exp(-i.w0.j), so only the outputs that survive decimation are
+// ever computed, each as one complex dot product with the real input, and
+// then rotated by exp(-i.w0.m.D) to complete the mix.
+//
+template <typename T, size_t FFTSZ> class ProcessorZoomFFT : public IProcessorZoomFFT
+{
+private :
+	size_t const decimation_ ;
+	double const sample_rate_ ;
+	double const centre_ ;
+
+	// the mixing filter, real and imaginary parts apart for the dot products.
+	std::vector<T> gr_ ;
+	std::vector<T> gi_ ;
+	// the mix at each decimated sample.
+	std::vector<std::complex<T>> rot_ ;
+
+	// working spaces
+	std::array<std::complex<T>, FFTSZ> fftin_ ;
+	std::array<std::complex<T>, FFTSZ> fftout_ ;
+	std::array<T, FFTSZ> out_ ;
+
+	// processor objects
+	Window<T, FFTSZ> window_ ;
+	FFT<T, FFTSZ>    fft_ ;
+
+public :
+	ProcessorZoomFFT ( window_t wt, double sample_rate, double centre, size_t decimation ) ;
+	virtual std::pair<T const*, T const*> operator () ( T const* ib, T const* ie ) final ;
+	virtual size_t width () final { return FFTSZ ; }
+	virtual size_t span () final { return ( FFTSZ - 1 ) * decimation_ + gr_.size () ; }
+	virtual size_t decimation () final { return decimation_ ; }
+	virtual double bin_frequency ( size_t k ) final ;
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; }
+} ;
+
+#include "ProcFFTZoomImpl.h"
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+// taps per unit of decimation in the anti-alias filter. Kaiser windowed sinc
+// with about 80dB of stopband, its transition takes up roughly the outer
+// tenth of the zoomed band at each end.
+const size_t ZoomTapsPerDecimation = 32 ;
+
+template <typename T, size_t FFTSZ>
+ProcessorZoomFFT<T, FFTSZ>::ProcessorZoomFFT ( window_t wt, double sample_rate, double centre, size_t decimation ) :
+	decimation_ ( decimation ), sample_rate_ ( sample_rate ), centre_ ( centre ), window_ ( wt )
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+
+	// low pass at the decimated Nyquist, normalised to unity gain at DC.
+	size_t const taps = decimation_ == 1 ? 1 : ZoomTapsPerDecimation * decimation_ ;
+	double const fc = 0.5 / static_cast<double>( decimation_ ) ;
+	double const beta = 8.0 ;
+	double const i0b = bessel_i0 ( beta ) ;
+	std::vector<double> h ( taps ) ;
+	for ( size_t j = 0; j < taps; ++j )
+	{
+		double const t = static_cast<double>( j ) - ( taps - 1 ) / 2.0 ;
+		double const sinc = t == 0 ? 2 * fc : std::sin ( 2 * std::numbers::pi * fc * t ) / ( std::numbers::pi * t ) ;
+		double const r = taps == 1 ? 0 : 2.0 * static_cast<double>( j ) / static_cast<double>( taps - 1 ) - 1.0 ;
+		h[j] = sinc * bessel_i0 ( beta * std::sqrt ( std::max ( 0.0, 1.0 - r * r ))) / i0b ;
+	}
+	double const sum = std::accumulate ( h.begin (), h.end (), 0.0 ) ;
+
+	double const w0 = 2 * std::numbers::pi * centre_ / sample_rate_ ;
+	gr_.resize ( taps ) ;
+	gi_.resize ( taps ) ;
+	for ( size_t j = 0; j < taps; ++j )
+	{
+		gr_[j] = static_cast<T>( h[j] / sum * std::cos ( w0 * static_cast<double>( j ))) ;
+		gi_[j] = static_cast<T>( -h[j] / sum * std::sin ( w0 * static_cast<double>( j ))) ;
+	}
+	rot_.resize ( FFTSZ ) ;
+	for ( size_t m = 0; m < FFTSZ; ++m )
+	{
+		// reduce the phase in double before it grows large.
+		double const ph = std::fmod ( w0 * static_cast<double>( m * decimation_ ), 2 * std::numbers::pi ) ;
+		rot_[m] = std::complex<T> ( static_cast<T>( std::cos ( ph )), static_cast<T>( -std::sin ( ph ))) ;
+	}
+}
+
+// bin k of the output, lowest frequency first.
+template <typename T, size_t FFTSZ>
+double ProcessorZoomFFT<T, FFTSZ>::bin_frequency ( size_t k )
+{
+	return centre_ + ( static_cast<double>( k ) - static_cast<double>( FFTSZ / 2 )) * sample_rate_ / static_cast<double>( decimation_ * FFTSZ ) ;
+}
+
+template <typename T, size_t FFTSZ>
+std::pair<T const*, T const*> ProcessorZoomFFT<T, FFTSZ>::operator () ( T const* ib, T const* )
+{
+	size_t const taps = gr_.size () ;
+	for ( size_t m = 0; m < FFTSZ; ++m )
+	{
+		T const* x = ib + m * decimation_ ;
+		T re { 0 } ;
+		T im { 0 } ;
+		for ( size_t j = 0; j < taps; ++j )
+		{
+			re += gr_[j] * x[j] ;
+			im += gi_[j] * x[j] ;
+		}
+		fftin_[m] = std::complex<T> ( re, im ) * rot_[m] * window_[m] ;
+	}
+	fft_ ( fftin_.data (), fftout_.data ()) ;
+
+	// the mixed signal is complex, so both halves of the spectrum mean something. Negative
+	// frequencies first. A real sine of amplitude A mixes to A/2, hence the same scaling as ProcessorFFT.
+	T const factor = T { 2.0 } * window_.Gain () / FFTSZ ;
+	for ( size_t k = 0; k < FFTSZ; ++k )
+		out_[k] = std::abs ( fftout_[( k + FFTSZ / 2 ) & ( FFTSZ - 1 )] ) * factor ;
+
+	return std::make_pair ( out_.data (), out_.data () + FFTSZ ) ;
+}
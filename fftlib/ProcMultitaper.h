@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "Arena.h"
+#include "FFT.h"
+#include "Slepian.h"
+
+// Thomson's multitaper estimate. The frame is loaded once and multiplied by
+// each Slepian taper in turn, two tapers to a transform as its real and
+// imaginary parts, and the K eigenspectra are combined bin by bin with the
+// adaptive weights, which lean on the better concentrated tapers where the
+// spectrum is weak and broadband leakage would otherwise show.
+//
+template <typename T, size_t FFTSZ> class ProcessorMultitaper : public IProcessorMultitaper, public arena_object
+{
+private :
+	// the tapers one after another and the fraction of each one's energy in the band,
+	// shared by every processor of this width, nw and K.
+	struct table_t
+	{
+		std::vector<T, arena_allocator<T>> taper_ ;
+		std::vector<double> lambda_ ;
+	} ;
+	std::shared_ptr<table_t const> table_ ;
+	size_t const tapers_ ;
+
+	// the frame, the eigenspectra one after another, and the estimate.
+	std::vector<T, arena_allocator<T>> x_ ;
+	std::vector<T, arena_allocator<T>> sk_ ;
+	std::vector<fp_t> out_ ;
+
+	// working spaces
+	alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftin_ ;
+	alignas ( ArenaAlign ) std::array<std::complex<T>, FFTSZ> fftout_ ;
+
+	// processor objects
+	FFT<T, FFTSZ> fft_ ;
+
+	static void Fill ( double nw, size_t tapers, table_t& t ) ;
+	T Combine ( size_t j, T var ) const ;
+
+public :
+	ProcessorMultitaper ( double nw, size_t tapers ) ;
+	virtual std::pair<fp_t const*, fp_t const*> operator () ( fp_t const* ib, fp_t const* ie ) final ;
+	virtual size_t width () final { return FFTSZ ; }
+	virtual size_t tapers () final { return tapers_ ; }
+	virtual double concentration ( size_t k ) final { return k < tapers_ ? table_->lambda_[k] : 0.0 ; }
+	void Strategy ( fft_strategy_t st ) { fft_.Strategy ( st ) ; }
+} ;
+
+#include "ProcMultitaperImpl.h"
@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+// the adaptive weights' iterations stop when the estimate moves less than this, relatively, or after so many.
+const double MultitaperTolerance  = 1e-3 ;
+const int    MultitaperIterations = 16 ;
+
+template <typename T, size_t FFTSZ>
+ProcessorMultitaper<T, FFTSZ>::ProcessorMultitaper ( double nw, size_t tapers ) : tapers_ ( tapers ),
+	x_ ( FFTSZ ), sk_ ( tapers * ( FFTSZ / 2 )), out_ ( FFTSZ / 2 )
+{
+	static_assert(std::popcount(FFTSZ) == 1, "FFTSZ must be a power of 2.");
+	table_ = shared_table<table_t, std::pair<double, size_t>>::get ( { nw, tapers }, [ nw, tapers ] ( table_t& t ) { Fill ( nw, tapers, t ) ; }) ;
+}
+
+// lambda is the sum over lags m of the taper's autocorrelation times sin(2.pi.W.m) / (pi.m), W = nw / FFTSZ,
+// found by Parseval over 2 * FFTSZ points, enough for every lag. Their even bins are the FFTSZ point
+// transform of what's given, folded, and their odd bins that of it shifted half a bin. The tapers
+// are independent, so they're found in parallel.
+//
+template <typename T, size_t FFTSZ>
+void ProcessorMultitaper<T, FFTSZ>::Fill ( double nw, size_t tapers, table_t& t )
+{
+	using cd = std::complex<double> ;
+	double const W = nw / double ( FFTSZ ) ;
+	auto sinc = [ W ] ( double m ) { return m == 0 ? 2 * W : std::sin ( 2 * std::numbers::pi * W * m ) / ( std::numbers::pi * m ) ; } ;
+	auto shift = [] ( size_t n ) { return std::polar ( 1.0, -std::numbers::pi * double ( n ) / double ( FFTSZ )) ; } ;
+
+	FFT<double, FFTSZ> fft ;
+	// the kernel's transform, real since the kernel is even.
+	std::vector<cd> se ( FFTSZ ) ;
+	std::vector<cd> so ( FFTSZ ) ;
+	std::vector<cd> scratch ( FFTSZ ) ;
+	for ( size_t m = 0; m < FFTSZ; ++m )
+	{
+		double const wrapped = m ? sinc ( double ( m ) - double ( FFTSZ )) : 0.0 ;
+		se[m] = sinc ( double ( m )) + wrapped ;
+		so[m] = ( sinc ( double ( m )) - wrapped ) * shift ( m ) ;
+	}
+	fft ( se.data (), se.data (), scratch.data ()) ;
+	fft ( so.data (), so.data (), scratch.data ()) ;
+
+	t.taper_.resize ( tapers * FFTSZ ) ;
+	t.lambda_.resize ( tapers ) ;
+	parallel_for ( tapers, 1, [ & ] ( size_t b, size_t e )
+		{
+			std::vector<double> v ( FFTSZ ) ;
+			std::vector<cd> ve ( FFTSZ ) ;
+			std::vector<cd> vo ( FFTSZ ) ;
+			std::vector<cd> buf ( FFTSZ ) ;
+			for ( size_t k = b; k < e; ++k )
+			{
+				slepian_sequence ( FFTSZ, nw, k, v.data ()) ;
+				for ( size_t n = 0; n < FFTSZ; ++n )
+				{
+					t.taper_[k * FFTSZ + n] = static_cast<T>( v[n] ) ;
+					ve[n] = v[n] ;
+					vo[n] = v[n] * shift ( n ) ;
+				}
+				fft ( ve.data (), ve.data (), buf.data ()) ;
+				fft ( vo.data (), vo.data (), buf.data ()) ;
+				double lambda = 0 ;
+				for ( size_t j = 0; j < FFTSZ; ++j )
+					lambda += std::norm ( ve[j] ) * se[j].real () + std::norm ( vo[j] ) * so[j].real () ;
+				t.lambda_[k] = std::clamp ( lambda / ( 2.0 * FFTSZ ), 0.0, 1.0 ) ;
+			}
+		}) ;
+}
+
+// the estimate at bin j, starting from the first two eigenspectra's mean and iterating
+// d[k] = sqrt(lambda[k]) S / (lambda[k] S + (1 - lambda[k]) var), S = sum d[k]^2 S[k] / sum d[k]^2.
+//
+template <typename T, size_t FFTSZ>
+T ProcessorMultitaper<T, FFTSZ>::Combine ( size_t j, T var ) const
+{
+	constexpr size_t bins = FFTSZ / 2 ;
+	double s = tapers_ > 1 ? ( sk_[j] + sk_[bins + j] ) / 2.0 : sk_[j] ;
+	for ( int it = 0; it < MultitaperIterations && s > 0; ++it )
+	{
+		double num = 0 ;
+		double den = 0 ;
+		for ( size_t k = 0; k < tapers_; ++k )
+		{
+			double const l = table_->lambda_[k] ;
+			double const d = std::sqrt ( l ) * s / ( l * s + ( 1 - l ) * var ) ;
+			num += d * d * sk_[k * bins + j] ;
+			den += d * d ;
+		}
+		double const next = num / den ;
+		bool const done = std::abs ( next - s ) <= MultitaperTolerance * next ;
+		s = next ;
+		if ( done )
+			break ;
+	}
+	return static_cast<T>( s ) ;
+}
+
+// a frame of FFTSZ, fewer samples are followed by zeros. The square roots of the power in each
+// bin, twice the density over FFTSZ but for bin 0, so their squares sum to the frame's mean square.
+//
+template <typename T, size_t FFTSZ>
+std::pair<fp_t const*, fp_t const*> ProcessorMultitaper<T, FFTSZ>::operator () ( fp_t const* ib, fp_t const* ie )
+{
+	constexpr size_t bins = FFTSZ / 2 ;
+	size_t const live = std::min<size_t> ( ie - ib, FFTSZ ) ;
+	double sum = 0 ;
+	for ( size_t n = 0; n < live; ++n )
+	{
+		x_[n] = static_cast<T>( ib[n] ) ;
+		sum += double ( x_[n] ) * x_[n] ;
+	}
+	std::fill ( x_.begin () + live, x_.end (), T { 0 } ) ;
+	T const var = static_cast<T>( sum / FFTSZ ) ;
+
+	T const* v = table_->taper_.data () ;
+	for ( size_t k = 0; k < tapers_; k += 2 )
+	{
+		T const* a = v + k * FFTSZ ;
+		if ( k + 1 < tapers_ )
+		{
+			T const* b = a + FFTSZ ;
+			for ( size_t n = 0; n < FFTSZ; ++n )
+				fftin_[n] = std::complex<T> ( x_[n] * a[n], x_[n] * b[n] ) ;
+		}
+		else
+		{
+			for ( size_t n = 0; n < FFTSZ; ++n )
+				fftin_[n] = std::complex<T> ( x_[n] * a[n], T { 0 } ) ;
+		}
+		fft_ ( fftin_.data (), fftout_.data ()) ;
+		for ( size_t j = 0; j < bins; ++j )
+		{
+			auto const [ x, y ] = split_pair<T, FFTSZ> ( fftout_.data (), j ) ;
+			sk_[k * bins + j] = std::norm ( x ) ;
+			if ( k + 1 < tapers_ )
+				sk_[( k + 1 ) * bins + j] = std::norm ( y ) ;
+		}
+	}
+
+	for ( size_t j = 0; j < bins; ++j )
+		out_[j] = static_cast<fp_t>( std::sqrt ( Combine ( j, var ) * T ( j ? 2.0 : 1.0 ) / T ( FFTSZ ))) ;
+	return std::make_pair ( out_.data (), out_.data () + bins ) ;
+}
@@ -0,0 +1,82 @@
+//
+//	SPSCRing.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <vector>
+
+// single producer, single consumer ring of preallocated slots. Slots are filled
+// and read in place, the producer takes the next free one with acquire (), fills
+// it and hands it over with publish (), the consumer looks at the oldest with
+// front () and gives it back with release (). Neither side ever waits or locks,
+// a full or empty ring gives nullptr. Head and tail live on their own cache lines
+// and each side keeps a copy of the other's index so it only reloads it when the
+// ring looks full or empty.
+//
+template <typename T> class spsc_ring
+{
+private :
+	static constexpr size_t line_ = 64 ;
+
+	std::vector<T> slots_ ;
+	size_t const   mask_ ;
+
+	alignas ( line_ ) std::atomic<size_t> head_ ;	// next to publish, written by the producer
+	size_t tail_seen_ ;
+	alignas ( line_ ) std::atomic<size_t> tail_ ;	// next to release, written by the consumer
+	size_t head_seen_ ;
+	alignas ( line_ ) char pad_ [ line_ ] ;
+
+public :
+	// capacity is rounded up to a power of 2, 'proto' is copied into every slot.
+	spsc_ring ( size_t capacity, T const& proto ) : slots_ ( std::bit_ceil ( std::max<size_t> ( capacity, 1 )), proto ),
+		mask_ ( slots_.size () - 1 ), head_ ( 0 ), tail_seen_ ( 0 ), tail_ ( 0 ), head_seen_ ( 0 )
+	{
+	}
+	spsc_ring ( spsc_ring const& ) = delete ;
+	spsc_ring& operator = ( spsc_ring const& ) = delete ;
+
+	// producer
+	T* acquire ()
+	{
+		size_t const h = head_.load ( std::memory_order_relaxed ) ;
+		if ( h - tail_seen_ == slots_.size ())
+		{
+			tail_seen_ = tail_.load ( std::memory_order_acquire ) ;
+			if ( h - tail_seen_ == slots_.size ())
+				return nullptr ;
+		}
+		return &slots_[h & mask_] ;
+	}
+	void publish ()
+	{
+		head_.store ( head_.load ( std::memory_order_relaxed ) + 1, std::memory_order_release ) ;
+	}
+
+	// consumer
+	T* front ()
+	{
+		size_t const t = tail_.load ( std::memory_order_relaxed ) ;
+		if ( t == head_seen_ )
+		{
+			head_seen_ = head_.load ( std::memory_order_acquire ) ;
+			if ( t == head_seen_ )
+				return nullptr ;
+		}
+		return &slots_[t & mask_] ;
+	}
+	void release ()
+	{
+		tail_.store ( tail_.load ( std::memory_order_relaxed ) + 1, std::memory_order_release ) ;
+	}
+
+	size_t capacity () const { return slots_.size () ; }
+} ;
@@ -0,0 +1,240 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <complex>
+#include <algorithm>
+#include <memory>
+
+#include "fftlib.h"
+
+#include "Service.h"
+
+namespace
+{
+	// a buffer's frames are split into pieces of about this many samples, enough to amortise a task.
+	const size_t PieceSamples = size_t(1) << 16;
+
+	// the service and worker the calling thread is, if it is one, so its submissions stay local.
+	thread_local FFTService const* this_service = nullptr;
+	thread_local size_t this_worker = 0;
+}
+
+FFTService::FFTService(size_t workers) : next_(0), sleepers_(0), stop_(false), tasks_(0), stolen_(0), completed_(0), cancelled_(0)
+{
+	for (auto& q : queued_)
+		q.store(0, std::memory_order_relaxed);
+	if (workers == 0)
+		workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+	for (size_t n = 0; n < workers; ++n)
+		workers_.push_back(std::make_unique<worker_t>());
+	for (size_t n = 0; n < workers; ++n)
+		workers_[n]->thread_ = std::thread([this, n]() { Work(n); });
+}
+
+FFTService::~FFTService()
+{
+	{
+		std::lock_guard<std::mutex> l(idle_lock_);
+		stop_ = true;
+	}
+	idle_.notify_all();
+	for (auto& w : workers_)
+		w->thread_.join();
+}
+
+IProcessorFFT const* FFTService::Plan(size_t width, window_t wt)
+{
+	std::lock_guard<std::mutex> l(plan_lock_);
+	auto& p = plans_[{ width, wt }];
+	if (!p)
+		p = make_fft(width, wt);
+	return p.get();
+}
+
+IFFTWorkspace& FFTService::Space(size_t self, IProcessorFFT const* plan)
+{
+	auto& ws = workers_[self]->spaces_[plan];
+	if (!ws)
+		ws = plan->make_workspace();
+	return *ws;
+}
+
+// to the calling worker's own queue, or the next in turn's, then wake a sleeper if there is one.
+void FFTService::Push(size_t level, task_t t)
+{
+	size_t const w = this_service == this ? this_worker : next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+	{
+		std::lock_guard<std::mutex> l(workers_[w]->lock_);
+		workers_[w]->queue_[level].push_back(std::move(t));
+	}
+	queued_[level].fetch_add(1);
+	if (sleepers_.load() != 0)
+	{
+		{
+			std::lock_guard<std::mutex> l(idle_lock_);
+		}
+		idle_.notify_one();
+	}
+}
+
+// the highest priority there is, the newest of our own or the oldest of another's.
+bool FFTService::Pop(size_t self, task_t& t)
+{
+	for (size_t level = 0; level < levels_; ++level)
+	{
+		if (queued_[level].load(std::memory_order_relaxed) == 0)
+			continue;
+		for (size_t i = 0; i < workers_.size(); ++i)
+		{
+			size_t const w = (self + i) % workers_.size();
+			std::lock_guard<std::mutex> l(workers_[w]->lock_);
+			auto& q = workers_[w]->queue_[level];
+			if (q.empty())
+				continue;
+			if (i == 0)
+			{
+				t = std::move(q.back());
+				q.pop_back();
+			}
+			else
+			{
+				t = std::move(q.front());
+				q.pop_front();
+				stolen_.fetch_add(1, std::memory_order_relaxed);
+			}
+			queued_[level].fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FFTService::Work(size_t self)
+{
+	this_service = this;
+	this_worker = self;
+	auto queued = [this]() { return queued_[0].load() + queued_[1].load() + queued_[2].load() != 0; };
+	task_t t;
+	while (true)
+	{
+		if (Pop(self, t))
+		{
+			t(self);
+			t = nullptr;
+			tasks_.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		std::unique_lock<std::mutex> l(idle_lock_);
+		sleepers_.fetch_add(1);
+		idle_.wait(l, [&]() { return stop_ || queued(); });
+		sleepers_.fetch_sub(1);
+		if (stop_ && !queued())
+			return;
+	}
+}
+
+// frames [fb, fe) of the request, summed here then into the request's total.
+void FFTService::Piece(size_t self, request_t& r, size_t fb, size_t fe)
+{
+	if (!r.cancelled_->load(std::memory_order_relaxed))
+	{
+		auto& ws = Space(self, r.plan_);
+		std::vector<double> sum(r.width_ / 2);
+		size_t const hop = r.width_ / 2;
+		size_t done = 0;
+		for (size_t f = fb; f < fe && !r.cancelled_->load(std::memory_order_relaxed); ++f, ++done)
+		{
+			fp_t const* b = r.samples_.data() + f * hop;
+			auto [ob, oe] = r.plan_->execute(b, b + std::min(r.width_, r.samples_.size() - f * hop), ws);
+			std::transform(sum.begin(), sum.end(), ob, sum.begin(), std::plus<>());
+		}
+		std::lock_guard<std::mutex> l(r.sum_lock_);
+		std::transform(r.sum_.begin(), r.sum_.end(), sum.begin(), r.sum_.begin(), std::plus<>());
+		r.done_.fetch_add(done, std::memory_order_relaxed);
+	}
+	if (r.left_.fetch_sub(1) == 1)
+		Finish(r);
+}
+
+void FFTService::Finish(request_t& r)
+{
+	fft_result_t res{ fft_status_t::DONE, r.done_.load(), {} };
+	if (res.frames < r.frames_)
+	{
+		res.status = fft_status_t::CANCELLED;
+		cancelled_.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		res.magnitudes.resize(r.width_ / 2);
+		std::transform(r.sum_.begin(), r.sum_.end(), res.magnitudes.begin(), [n = double(r.frames_)](double s) { return fp_t(s / n); });
+		completed_.fetch_add(1, std::memory_order_relaxed);
+	}
+	// the request lives on until its last task is destroyed, the samples needn't.
+	r.samples_ = std::vector<fp_t>();
+	r.promise_.set_value(std::move(res));
+}
+
+fft_request_t FFTService::Submit(size_t width, window_t wt, std::vector<fp_t> samples, size_t frames, fft_priority_t pr)
+{
+	auto r = std::make_shared<request_t>();
+	auto cancelled = std::make_shared<std::atomic<bool>>(false);
+	fft_request_t req{ r->promise_.get_future(), cancelled };
+	IProcessorFFT const* plan = width >= FFTWdMin && width <= FFTWdMax ? Plan(width, wt) : nullptr;
+	if (!plan || frames == 0)
+	{
+		r->promise_.set_value(fft_result_t{ fft_status_t::FAILED, 0, {} });
+		return req;
+	}
+	r->cancelled_ = std::move(cancelled);
+	r->plan_ = plan;
+	r->samples_ = std::move(samples);
+	r->width_ = size_t(1) << width;
+	r->frames_ = frames;
+	r->done_.store(0, std::memory_order_relaxed);
+	r->sum_.resize(r->width_ / 2);
+
+	size_t const per = std::max<size_t>(1, PieceSamples / r->width_);
+	size_t const pieces = (frames + per - 1) / per;
+	r->left_.store(pieces, std::memory_order_relaxed);
+	for (size_t p = 0; p < pieces; ++p)
+	{
+		size_t const fb = p * per;
+		size_t const fe = std::min(frames, fb + per);
+		Push(static_cast<size_t>(pr), [this, r, fb, fe](size_t self) { Piece(self, *r, fb, fe); });
+	}
+	return req;
+}
+
+fft_request_t FFTService::submit_frame(size_t width, window_t wt, std::vector<fp_t> frame, fft_priority_t pr)
+{
+	size_t const frames = frame.empty() ? 0 : 1;
+	return Submit(width, wt, std::move(frame), frames, pr);
+}
+
+fft_request_t FFTService::submit_buffer(size_t width, window_t wt, std::vector<fp_t> samples, fft_priority_t pr)
+{
+	// half overlapped, as fftit.
+	size_t const w = size_t(1) << std::min<size_t>(width, 63);
+	size_t const frames = samples.size() < w ? 0 : (samples.size() - w) / (w / 2) + 1;
+	return Submit(width, wt, std::move(samples), frames, pr);
+}
+
+service_stats_t FFTService::stats() const
+{
+	uint64_t plans = 0;
+	{
+		std::lock_guard<std::mutex> l(plan_lock_);
+		plans = plans_.size();
+	}
+	return { tasks_.load(std::memory_order_relaxed), stolen_.load(std::memory_order_relaxed), completed_.load(std::memory_order_relaxed),
+		cancelled_.load(std::memory_order_relaxed), plans };
+}
+
+std::unique_ptr<IFFTService> make_fft_service(size_t workers)
+{
+	return std::make_unique<FFTService>(workers);
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a work stealing pool for IFFTService. Every worker has a deque for each
+// priority, pushes and pops its own at the back and is stolen from at the
+// front, so a worker keeps to what's hot in its cache and thieves take the
+// oldest, largest remainder. Requests become tasks, a frame one and a buffer
+// one per piece of its frames, that sum into the request's state, the last
+// to finish keeping the promise. The processors are the plans, shared, and
+// each worker has its own workspace for each.
+//
+class FFTService : public IFFTService
+{
+private :
+	static constexpr size_t levels_ = 3 ;
+	// the worker running it.
+	using task_t = std::function<void ( size_t )> ;
+
+	struct worker_t
+	{
+		std::mutex lock_ ;
+		std::deque<task_t> queue_ [ levels_ ] ;
+		// only ever touched by the worker's thread.
+		std::map<IProcessorFFT const*, std::unique_ptr<IFFTWorkspace>> spaces_ ;
+		std::thread thread_ ;
+	} ;
+
+	struct request_t
+	{
+		std::promise<fft_result_t> promise_ ;
+		std::shared_ptr<std::atomic<bool>> cancelled_ ;
+		IProcessorFFT const* plan_ ;
+		std::vector<fp_t> samples_ ;
+		size_t width_ ;
+		size_t frames_ ;
+		std::atomic<size_t> left_ ;
+		std::atomic<size_t> done_ ;
+		std::mutex sum_lock_ ;
+		std::vector<double> sum_ ;
+	} ;
+
+	std::vector<std::unique_ptr<worker_t>> workers_ ;
+	// what's queued at each priority, so empty ones are passed over without locking.
+	std::atomic<size_t> queued_ [ levels_ ] ;
+	std::atomic<size_t> next_ ;
+	std::mutex idle_lock_ ;
+	std::condition_variable idle_ ;
+	std::atomic<size_t> sleepers_ ;
+	bool stop_ ;
+
+	// the plans, by width and window, kept for the service's life.
+	mutable std::mutex plan_lock_ ;
+	std::map<std::pair<size_t, window_t>, std::unique_ptr<IProcessorFFT>> plans_ ;
+
+	std::atomic<uint64_t> tasks_ ;
+	std::atomic<uint64_t> stolen_ ;
+	std::atomic<uint64_t> completed_ ;
+	std::atomic<uint64_t> cancelled_ ;
+
+	IProcessorFFT const* Plan ( size_t width, window_t wt ) ;
+	IFFTWorkspace& Space ( size_t self, IProcessorFFT const* plan ) ;
+	fft_request_t Submit ( size_t width, window_t wt, std::vector<fp_t> samples, size_t frames, fft_priority_t pr ) ;
+	void Push ( size_t level, task_t t ) ;
+	bool Pop ( size_t self, task_t& t ) ;
+	void Piece ( size_t self, request_t& r, size_t fb, size_t fe ) ;
+	void Finish ( request_t& r ) ;
+	void Work ( size_t self ) ;
+
+public :
+	explicit FFTService ( size_t workers ) ;
+	virtual ~FFTService () final ;
+	virtual fft_request_t submit_frame ( size_t width, window_t wt, std::vector<fp_t> frame, fft_priority_t pr ) final ;
+	virtual fft_request_t submit_buffer ( size_t width, window_t wt, std::vector<fp_t> samples, fft_priority_t pr ) final ;
+	virtual size_t workers () final { return workers_.size () ; }
+	virtual service_stats_t stats () const final ;
+} ;
@@ -0,0 +1,40 @@
+//
+//	SharedTable.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Arena.h"
+
+// one immutable Table per Key, shared by everything that asks for it while any
+// of them still holds it, and released with the last. The first to ask fills it,
+// under the lock, so concurrent constructors wait for it rather than build their own.
+// Tables come from the arena.
+//
+template <typename Table, typename Key> class shared_table
+{
+private :
+	static inline std::mutex lock_ ;
+	static inline std::map<Key, std::weak_ptr<Table const>> tables_ ;
+
+public :
+	template <typename F> static std::shared_ptr<Table const> get ( Key const& key, F fill )
+	{
+		std::lock_guard<std::mutex> l ( lock_ ) ;
+		auto& w = tables_[key] ;
+		if ( auto p = w.lock ())
+			return p ;
+		auto t = std::allocate_shared<Table> ( arena_allocator<Table> ()) ;
+		fill ( *t ) ;
+		w = t ;
+		return t ;
+	}
+} ;
@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+#include "Slepian.h"
+
+namespace
+{
+	// bisection steps, from the Gershgorin bounds to well inside the gap to the next eigenvalue,
+	// and inverse iterations from there.
+	const int Bisections = 52;
+	const int Iterations = 3;
+
+	// the matrix, scaled by 1/n^2 so its eigenvalues are below 1. d on the diagonal, e[i] couples i - 1 and i.
+	struct tridiagonal_t
+	{
+		std::vector<double> d;
+		std::vector<double> e;
+	};
+
+	tridiagonal_t prolate(size_t n, double nw)
+	{
+		tridiagonal_t t{ std::vector<double>(n), std::vector<double>(n, 0.0) };
+		double const c = std::cos(2 * std::numbers::pi * nw / double(n));
+		double const nn = double(n) * double(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			double const h = (double(n) - 1 - 2 * double(i)) / 2;
+			t.d[i] = h * h * c / nn;
+			t.e[i] = double(i) * double(n - i) / 2 / nn;
+		}
+		return t;
+	}
+
+	// how many eigenvalues are less than x, from the signs of the pivots.
+	size_t below(tridiagonal_t const& t, double x)
+	{
+		size_t count = 0;
+		double q = 1;
+		for (size_t i = 0; i < t.d.size(); ++i)
+		{
+			q = t.d[i] - x - (i ? t.e[i] * t.e[i] / q : 0.0);
+			if (q == 0)
+				q = -std::numeric_limits<double>::epsilon() * (std::abs(t.d[i]) + std::abs(x) + std::numeric_limits<double>::min());
+			if (q < 0)
+				++count;
+		}
+		return count;
+	}
+
+	// solves (t - mu) y = x in place, LU with partial pivoting as LAPACK's dgttrf and dgtts2.
+	void shifted_solve(tridiagonal_t const& t, double mu, std::vector<double>& x)
+	{
+		size_t const n = t.d.size();
+		std::vector<double> dl(t.e.begin() + 1, t.e.end());
+		std::vector<double> dd(n);
+		std::vector<double> du(t.e.begin() + 1, t.e.end());
+		std::vector<double> du2(n, 0.0);
+		std::vector<bool> swapped(n, false);
+		std::transform(t.d.begin(), t.d.end(), dd.begin(), [mu](double d) { return d - mu; });
+		double const tiny = std::numeric_limits<double>::epsilon() * std::abs(mu) + std::numeric_limits<double>::min();
+		for (size_t i = 0; i + 1 < n; ++i)
+		{
+			if (std::abs(dd[i]) >= std::abs(dl[i]))
+			{
+				if (dd[i] == 0)
+					dd[i] = tiny;
+				double const f = dl[i] / dd[i];
+				dl[i] = f;
+				dd[i + 1] -= f * du[i];
+			}
+			else
+			{
+				double const f = dd[i] / dl[i];
+				dd[i] = dl[i];
+				dl[i] = f;
+				double const tmp = du[i];
+				du[i] = dd[i + 1];
+				dd[i + 1] = tmp - f * dd[i + 1];
+				if (i + 2 < n)
+				{
+					du2[i] = du[i + 1];
+					du[i + 1] = -f * du[i + 1];
+				}
+				swapped[i] = true;
+			}
+		}
+		if (dd[n - 1] == 0)
+			dd[n - 1] = tiny;
+
+		for (size_t i = 0; i + 1 < n; ++i)
+		{
+			if (swapped[i])
+				std::swap(x[i], x[i + 1]);
+			x[i + 1] -= dl[i] * x[i];
+		}
+		x[n - 1] /= dd[n - 1];
+		if (n > 1)
+			x[n - 2] = (x[n - 2] - du[n - 2] * x[n - 1]) / dd[n - 2];
+		for (size_t i = n - 2; i-- > 0; )
+			x[i] = (x[i] - du[i] * x[i + 1] - du2[i] * x[i + 2]) / dd[i];
+	}
+}
+
+void slepian_sequence(size_t n, double nw, size_t k, double* v)
+{
+	if (n == 1)
+	{
+		v[0] = 1;
+		return;
+	}
+	auto const t = prolate(n, nw);
+
+	// the k'th greatest eigenvalue has n - 1 - k below it.
+	double lo = 0;
+	double hi = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		double const r = t.e[i] + (i + 1 < n ? t.e[i + 1] : 0.0);
+		lo = std::min(lo, t.d[i] - r);
+		hi = std::max(hi, t.d[i] + r);
+	}
+	for (int b = 0; b < Bisections && hi - lo > std::numeric_limits<double>::epsilon() * std::abs(hi); ++b)
+	{
+		double const mid = (lo + hi) / 2;
+		if (below(t, mid) > n - 1 - k)
+			hi = mid;
+		else
+			lo = mid;
+	}
+	double const mu = (lo + hi) / 2;
+
+	// a start with some of every eigenvector in it, symmetric or not.
+	std::vector<double> x(n);
+	for (size_t i = 0; i < n; ++i)
+		x[i] = 1 + double(i) / double(n);
+	for (int it = 0; it < Iterations; ++it)
+	{
+		shifted_solve(t, mu, x);
+		double s = 0;
+		for (double a : x)
+			s += a * a;
+		s = 1 / std::sqrt(s);
+		for (double& a : x)
+			a *= s;
+	}
+
+	double sign = 0;
+	for (size_t i = 0; i < n; ++i)
+		sign += x[i] * (k % 2 == 0 ? 1.0 : double(n) - 1 - 2 * double(i));
+	if (sign < 0)
+		for (double& a : x)
+			a = -a;
+	std::copy(x.begin(), x.end(), v);
+}
@@ -0,0 +1,20 @@
+//
+//	Slepian.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <cstddef>
+
+// the k'th (from 0) discrete prolate spheroidal sequence of length n and
+// time-bandwidth nw, to v[0, n), the unit energy sequence with the k'th
+// greatest fraction of its energy within +/- nw / n cycles per sample. Found
+// as an eigenvector of the tridiagonal matrix that commutes with the sinc
+// kernel, by bisection for its eigenvalue and then inverse iteration. Even
+// k sum positive, odd k start positive.
+//
+void slepian_sequence ( size_t n, double nw, size_t k, double* v ) ;
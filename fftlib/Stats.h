@@ -0,0 +1,39 @@
+//
+//	Stats.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// accumulates the time since the previous lap into a phase counter.
+// when stats are off it does nothing beyond testing the flag, no clock reads.
+//
+class phase_timer
+{
+private :
+	using clock = std::chrono::steady_clock ;
+	bool const        on_ ;
+	clock::time_point t_ ;
+
+public :
+	explicit phase_timer ( bool on ) : on_ ( on )
+	{
+		if ( on_ )
+			t_ = clock::now () ;
+	}
+	void lap ( uint64_t& ns )
+	{
+		if ( on_ )
+		{
+			auto const n = clock::now () ;
+			ns += static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( n - t_ ).count ()) ;
+			t_ = n ;
+		}
+	}
+} ;
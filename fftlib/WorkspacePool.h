@@ -0,0 +1,71 @@
+//
+//	WorkspacePool.h
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// the workspaces of a processor P whose transform is const, so the operators, execute with a
+// pooled workspace and execute with the caller's all come to one Transform. P provides
+//     struct workspace_t, an IFFTWorkspace,
+//     std::unique_ptr<workspace_t> Workspace () const, a new one ready for use,
+//     Transform ( S const* ib, S const* ie, workspace_t& ws, fft_stats_t* stats ) const,
+// and befriends this. The operators' own workspace is made when first needed, the pool grows
+// to as many as are in use at once, and a caller's workspace must be one of P's.
+//
+template <typename P> class workspace_pool
+{
+private :
+	// held as IFFTWorkspace since P isn't complete here, each made by P::Workspace.
+	std::unique_ptr<IFFTWorkspace> own_ ;
+	mutable std::mutex pool_lock_ ;
+	mutable std::vector<std::unique_ptr<IFFTWorkspace>> pool_ ;
+
+	P const& Self () const { return static_cast<P const&>( *this ) ; }
+	template <typename W> static W& Cast ( IFFTWorkspace& ws ) { return static_cast<W&>( ws ) ; }
+
+protected :
+	template <typename S> std::pair<fp_t const*, fp_t const*> Own ( S const* ib, S const* ie, fft_stats_t* stats )
+	{
+		if ( !own_ )
+			own_ = Self ().Workspace () ;
+		return Self ().Transform ( ib, ie, Cast<typename P::workspace_t> ( *own_ ), stats ) ;
+	}
+
+	// a workspace from the pool, or a new one if they're all in use, returned when done.
+	template <typename S> void Pooled ( S const* ib, S const* ie, fp_t* out ) const
+	{
+		std::unique_ptr<IFFTWorkspace> ws ;
+		{
+			std::lock_guard<std::mutex> l ( pool_lock_ ) ;
+			if ( !pool_.empty ())
+			{
+				ws = std::move ( pool_.back ()) ;
+				pool_.pop_back () ;
+			}
+		}
+		if ( !ws )
+			ws = Self ().Workspace () ;
+		auto const r = Self ().Transform ( ib, ie, Cast<typename P::workspace_t> ( *ws ), nullptr ) ;
+		std::copy ( r.first, r.second, out ) ;
+		std::lock_guard<std::mutex> l ( pool_lock_ ) ;
+		pool_.push_back ( std::move ( ws )) ;
+	}
+
+	// another processor's workspace may be smaller, or laid out differently, so it's refused.
+	template <typename S> std::pair<fp_t const*, fp_t const*> Execute ( S const* ib, S const* ie, IFFTWorkspace& ws ) const
+	{
+		auto* w = dynamic_cast<typename P::workspace_t*>( &ws ) ;
+		if ( !w )
+			throw std::invalid_argument ( "execute: the workspace was made by a different kind of processor" ) ;
+		return Self ().Transform ( ib, ie, *w, nullptr ) ;
+	}
+} ;
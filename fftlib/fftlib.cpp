@@ -12,11 +12,30 @@
 #include <cmath>
 #include <numbers>
 #include <bit>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 #include "fftlib.h"
 
 #include "FFT.h"
+#include "FFTCore.h"
 #include "ProcFFT.h"
+#include "ProcFFTFixed.h"
+#include "ProcFFTMulti.h"
+#include "ProcFFTCross.h"
+#include "ProcFFTZoom.h"
+#include "ProcCorrelation.h"
+#include "ProcConvolution.h"
+#include "ProcAnalytic.h"
+#include "ProcMultitaper.h"
+#include "Dispatch.h"
 
 using namespace std::literals;
 
@@ -76,74 +95,411 @@ std::string_view wt_to_string(window_t wt)
 	}
 }
 
-std::unique_ptr<IProcessorFFT> make_fft(size_t width, window_t wt)
-{
-	switch (width)
-	{
-	case  8:
-		return std::unique_ptr<IProcessorFFT>( new ProcessorFFT<fp_t, 256>(wt));
-	case  9:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 512>(wt));
-	case 10:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 1024>(wt));
-	case 11:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 2048>(wt));
-	case 12:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 4096>(wt));
-	case 13:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 8192>(wt));
-	case 14:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 16384>(wt));
-	case 15:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 32768>(wt));
-	case 16:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 65536>(wt));
-	case 17:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 131072>(wt));
-	case 18:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 262144>(wt));
-	case 19:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 524288>(wt));
-	case 20:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 1048576>(wt));
-	case 21:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 2097152>(wt));
-	case 22:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 4194304>(wt));
-	case 23:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 8388608>(wt));
-	case 24:
-		return std::unique_ptr<IProcessorFFT>(new ProcessorFFT<fp_t, 16777216>(wt));
-	}
-	return std::unique_ptr<IProcessorFFT>();
+fft_strategy_t fft_strategy_default(size_t fftsz)
+{
+	// blocked from span 4, measured as a fair choice across sizes on
+	// a couple of machines. Never worse than the strided original.
+	return fft_strategy_t{ std::min<size_t>(4, fftsz) };
+}
+
+namespace
+{
+	// wisdom, the measured best strategy for each width and precision, shared by the whole process.
+	// One precision's best needn't be another's.
+	using wisdom_key_t = std::pair<size_t, precision_t>;
+	std::mutex wisdom_mtx;
+	std::map<wisdom_key_t, fft_strategy_t> wisdom;
+
+	// version 1 files have no precision column, and were all SINGLE's.
+	constexpr auto wisdom_header_v1 = "fftlib wisdom 1"sv;
+	constexpr auto wisdom_header = "fftlib wisdom 2"sv;
+
+	// the codes fftit's -E takes.
+	char precision_code(precision_t pr)
+	{
+		return pr == precision_t::DOUBLE ? 'd' : pr == precision_t::MIXED ? 'm' : pr == precision_t::FIXED ? 'x' : 'f';
+	}
+
+	bool precision_from_code(char c, precision_t& pr)
+	{
+		for (auto p : { precision_t::SINGLE, precision_t::DOUBLE, precision_t::MIXED })
+			if (precision_code(p) == c)
+			{
+				pr = p;
+				return true;
+			}
+		return false;
+	}
+
+	bool find_wisdom(size_t width, precision_t pr, fft_strategy_t& st)
+	{
+		std::lock_guard<std::mutex> l(wisdom_mtx);
+		auto it = wisdom.find({ width, pr });
+		if (it == wisdom.end())
+			return false;
+		st = it->second;
+		return true;
+	}
+
+	void add_wisdom(size_t width, precision_t pr, fft_strategy_t st)
+	{
+		std::lock_guard<std::mutex> l(wisdom_mtx);
+		wisdom[{ width, pr }] = st;
+	}
+
+	// time each candidate on a test signal, best of a few transforms, keep the fastest.
+	template<typename P> fft_strategy_t measure_strategy(P& p)
+	{
+		size_t const candidates[] = { p.width(), 256, 64, 16, 8, 4, 2, 1 };
+
+		std::vector<fp_t> signal(p.width());
+		fill_buffer_with_sine(fp_t(1000), signal.data(), signal.data() + signal.size(), 48000);
+		size_t const reps = std::clamp<size_t>((size_t(1) << 20) / p.width(), 2, 64);
+
+		fft_strategy_t best = fft_strategy_default(p.width());
+		auto best_t = std::chrono::steady_clock::duration::max();
+		for (auto split : candidates)
+		{
+			if (split > p.width())
+				continue;
+			p.Strategy(fft_strategy_t{ split });
+			p(signal.data(), signal.data() + signal.size());
+			for (size_t n = 0; n < reps; ++n)
+			{
+				auto s = std::chrono::steady_clock::now();
+				p(signal.data(), signal.data() + signal.size());
+				auto t = std::chrono::steady_clock::now() - s;
+				if (t < best_t)
+				{
+					best_t = t;
+					best.split = split;
+				}
+			}
+		}
+		p.Strategy(best);
+		return best;
+	}
+
+	// what wisdom says for the width in fp_t, or the default.
+	fft_strategy_t strategy_for(size_t width)
+	{
+		fft_strategy_t st;
+		if (find_wisdom(width, precision_t::SINGLE, st))
+			return st;
+		return fft_strategy_default(size_t(1) << width);
+	}
+
+	template<typename T, size_t FFTSZ, typename C = T> std::unique_ptr<IProcessorFFT> make_processor(size_t width, window_t wt, plan_t pt, precision_t pr)
+	{
+		auto p = std::make_unique<ProcessorFFT<T, FFTSZ, C>>(wt);
+		fft_strategy_t st;
+		if (find_wisdom(width, pr, st))
+			p->Strategy(st);
+		else
+		if (pt == plan_t::MEASURE && ProcessorFFT<T, FFTSZ, C>::Measurable())
+			add_wisdom(width, pr, measure_strategy(*p));
+		return p;
+	}
+}
+
+bool load_wisdom(char const* path)
+{
+	std::ifstream ifs(path);
+	std::string hdr;
+	if (!std::getline(ifs, hdr) || (hdr != wisdom_header && hdr != wisdom_header_v1))
+		return false;
+	bool const v1 = hdr == wisdom_header_v1;
+
+	std::map<wisdom_key_t, fft_strategy_t> loaded;
+	std::string line;
+	while (std::getline(ifs, line))
+	{
+		std::istringstream ls(line);
+		size_t width, split;
+		char code = precision_code(precision_t::SINGLE);
+		precision_t pr;
+		if (!(ls >> width) || (!v1 && !(ls >> code)) || !(ls >> split) || !(ls >> std::ws).eof())
+			return false;
+		if (width < FFTWdMin || width > FFTWdMax || split == 0 || !precision_from_code(code, pr))
+			return false;
+		loaded[{ width, pr }] = fft_strategy_t{ split };
+	}
+
+	std::lock_guard<std::mutex> l(wisdom_mtx);
+	for (auto& w : loaded)
+		wisdom[w.first] = w.second;
+	return true;
+}
+
+bool save_wisdom(char const* path)
+{
+	std::ofstream ofs(path, std::ios::trunc);
+	if (!ofs)
+		return false;
+	ofs << wisdom_header << "\n";
+
+	std::lock_guard<std::mutex> l(wisdom_mtx);
+	for (auto& w : wisdom)
+		ofs << w.first.first << " " << precision_code(w.first.second) << " " << w.second.split << "\n";
+	return !!ofs;
+}
+
+void forget_wisdom()
+{
+	std::lock_guard<std::mutex> l(wisdom_mtx);
+	wisdom.clear();
+}
+
+namespace
+{
+	// a frame of integer PCM in fp_t, full scale reading as 1.0, for the interface's defaults.
+	template<typename S> std::vector<fp_t> pcm_frame(S const* ib, S const* ie)
+	{
+		std::vector<fp_t> f(ie - ib);
+		std::transform(ib, ie, f.begin(), [](S s) { return static_cast<fp_t>(sample_value<double>(s) * sample_scale_v<S>); });
+		return f;
+	}
+
+	[[noreturn]] void not_reentrant()
+	{
+		throw std::logic_error("execute: the processor isn't reentrant");
+	}
+
+	template<typename S> void execute_once(IProcessorFFT const& p, S const* ib, S const* ie, fp_t* out)
+	{
+		auto ws = p.make_workspace();
+		if (!ws)
+			not_reentrant();
+		auto const r = p.execute(ib, ie, *ws);
+		std::copy(r.first, r.second, out);
+	}
+}
+
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::operator () (int16_t const* ib, int16_t const* ie)
+{
+	auto const f = pcm_frame(ib, ie);
+	return (*this)(f.data(), f.data() + f.size());
+}
+
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::operator () (pcm24_t const* ib, pcm24_t const* ie)
+{
+	auto const f = pcm_frame(ib, ie);
+	return (*this)(f.data(), f.data() + f.size());
+}
+
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::operator () (int32_t const* ib, int32_t const* ie)
+{
+	auto const f = pcm_frame(ib, ie);
+	return (*this)(f.data(), f.data() + f.size());
+}
+
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::execute(fp_t const*, fp_t const*, IFFTWorkspace&) const
+{
+	not_reentrant();
 }
 
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::execute(int16_t const*, int16_t const*, IFFTWorkspace&) const
+{
+	not_reentrant();
+}
+
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::execute(pcm24_t const*, pcm24_t const*, IFFTWorkspace&) const
+{
+	not_reentrant();
+}
+
+std::pair<fp_t const*, fp_t const*> IProcessorFFT::execute(int32_t const*, int32_t const*, IFFTWorkspace&) const
+{
+	not_reentrant();
+}
+
+void IProcessorFFT::execute(fp_t const* ib, fp_t const* ie, fp_t* out) const
+{
+	execute_once(*this, ib, ie, out);
+}
+
+void IProcessorFFT::execute(int16_t const* ib, int16_t const* ie, fp_t* out) const
+{
+	execute_once(*this, ib, ie, out);
+}
+
+void IProcessorFFT::execute(pcm24_t const* ib, pcm24_t const* ie, fp_t* out) const
+{
+	execute_once(*this, ib, ie, out);
+}
+
+void IProcessorFFT::execute(int32_t const* ib, int32_t const* ie, fp_t* out) const
+{
+	execute_once(*this, ib, ie, out);
+}
+
+std::unique_ptr<IProcessorFFT> make_fft(size_t width, window_t wt, plan_t pt, precision_t pr)
+{
+	return dispatch_width<std::unique_ptr<IProcessorFFT>>(width, [=](auto sz)
+		{
+			switch (pr)
+			{
+			case precision_t::DOUBLE:
+				return make_processor<double, sz()>(width, wt, pt, pr);
+			case precision_t::MIXED:
+				return make_processor<fp_t, sz(), double>(width, wt, pt, pr);
+			case precision_t::FIXED:
+				return std::unique_ptr<IProcessorFFT>(std::make_unique<ProcessorFFTFixed<sz()>>(wt));
+			default:
+				return make_processor<fp_t, sz()>(width, wt, pt, pr);
+			}
+		});
+}
+
+bool can_measure(size_t width, precision_t pr)
+{
+	return dispatch_width<bool>(width, [=](auto sz)
+		{
+			switch (pr)
+			{
+			case precision_t::DOUBLE:
+				return ProcessorFFT<double, sz()>::Measurable();
+			case precision_t::MIXED:
+				return ProcessorFFT<fp_t, sz(), double>::Measurable();
+			case precision_t::FIXED:
+				return false;
+			default:
+				return ProcessorFFT<fp_t, sz()>::Measurable();
+			}
+		});
+}
+
+std::unique_ptr<IProcessorFFTMulti> make_fft_multi(size_t width, window_t wt, size_t channels, size_t stride)
+{
+	if (stride == 0)
+		stride = channels;
+	if (channels == 0 || stride < channels)
+		return std::unique_ptr<IProcessorFFTMulti>();
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IProcessorFFTMulti>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorFFTMulti<fp_t, sz()>>(wt, channels, stride);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IProcessorCrossFFT> make_cross_fft(size_t width, window_t wt)
+{
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IProcessorCrossFFT>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorCrossFFT<fp_t, sz()>>(wt);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IProcessorZoomFFT> make_zoom_fft(size_t width, window_t wt, double sample_rate, double centre, size_t decimation)
+{
+	if (decimation == 0 || sample_rate <= 0)
+		return std::unique_ptr<IProcessorZoomFFT>();
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IProcessorZoomFFT>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorZoomFFT<fp_t, sz()>>(wt, sample_rate, centre, decimation);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IProcessorCorrelation> make_autocorrelation(size_t width, window_t wt)
+{
+	// the caller's width, the transforms' being one more.
+	if (width < FFTWdMin || width >= FFTWdMax)
+		return nullptr;
+	auto const st = strategy_for(width + 1);
+	return dispatch_width<std::unique_ptr<IProcessorCorrelation>>(width + 1, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorCorrelation<fp_t, sz(), false>>(wt);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IProcessorCorrelation> make_cepstrum(size_t width, window_t wt)
+{
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IProcessorCorrelation>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorCorrelation<fp_t, sz(), true>>(wt);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IProcessorMultitaper> make_multitaper(size_t width, double nw, size_t tapers)
+{
+	if (!(nw >= 1) || width < FFTWdMin || width > FFTWdMax || 2 * nw >= double(size_t(1) << width))
+		return nullptr;
+	if (tapers == 0)
+		tapers = static_cast<size_t>(2 * nw) - 1;
+	if (tapers > static_cast<size_t>(2 * nw))
+		return nullptr;
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IProcessorMultitaper>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorMultitaper<fp_t, sz()>>(nw, tapers);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IConvolver> make_convolver(size_t width, fp_t const* kernel_b, fp_t const* kernel_e)
+{
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IConvolver>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorConvolution<fp_t, sz()>>(kernel_b, kernel_e);
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IAnalyticSignal> make_analytic_signal(size_t width)
+{
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IAnalyticSignal>>(width, [=](auto sz)
+		{
+			auto p = std::make_unique<ProcessorAnalytic<fp_t, sz()>>();
+			p->Strategy(st);
+			return p;
+		});
+}
+
+std::unique_ptr<IFFTCore<fp_t>> make_fft_core(size_t width, int invert)
+{
+	auto const st = strategy_for(width);
+	return dispatch_width<std::unique_ptr<IFFTCore<fp_t>>>(width, [=](auto sz) -> std::unique_ptr<IFFTCore<fp_t>>
+		{
+			if (invert == -1)
+				return std::make_unique<FFTCore<fp_t, sz(), -1>>(st);
+			return std::make_unique<FFTCore<fp_t, sz(), 1>>(st);
+		});
+}
+
+// the phase is kept in cycles, in [0, 1) and in double, so it neither loses precision as time
+// goes on nor drifts from the increment's rounding, either of which moves the frequency.
 template <typename F> class angle_generator
 {
 private:
-	size_t ind_;
-	size_t interval_;
-	F      frequency_;
-	F      time_;
-	F      tinc_;
+	double phase_;
+	double inc_;
 
 public:
-	angle_generator(F frequency, size_t sample_rate) : ind_(0), frequency_(frequency), time_(0)
+	angle_generator(F frequency, size_t sample_rate) : phase_(0), inc_(double(frequency) / sample_rate)
 	{
-		interval_ = 40 * sample_rate / static_cast<size_t> (frequency_);
-		tinc_ = 1.0 / sample_rate;
 	}
 	F operator ()()
 	{
-		F ret = static_cast<F>(std::numbers::pi_v<fp_t> * 2.0 * frequency_ * time_);
-		time_ += tinc_;
-		++ind_;
-		if (ind_ == interval_)
-		{
-			ind_ = 0;
-			fp_t f = ::floor(time_);
-			time_ -= f;
-		}
+		F ret = static_cast<F>(2.0 * std::numbers::pi * phase_);
+		phase_ += inc_;
+		phase_ -= std::floor(phase_);
 		return ret;
 	}
 };
@@ -10,15 +10,86 @@
 #include <utility>
 #include <string_view>
 #include <memory>
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <vector>
 
 using fp_t = float;
 
+// packed little endian 24 bit PCM, three bytes a sample, reading as its integer value.
+//
+struct pcm24_t
+{
+	uint8_t b[3];
+	operator int32_t() const { return static_cast<int32_t>((uint32_t(b[2]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[0]) << 8)) >> 8; }
+};
+static_assert(sizeof(pcm24_t) == 3, "pcm24_t must be packed");
+
+// what a processor has done, and where the time went. Times are nanoseconds,
+// and only accumulate while stats are enabled, which they are not by default.
+//
+struct fft_stats_t
+{
+	uint64_t frames;       // transforms performed
+	uint64_t bytes;        // input consumed
+	uint64_t window_ns;    // windowing the input and loading the transform
+	uint64_t fft_ns;       // the butterflies
+	uint64_t magnitude_ns; // magnitude and scaling of the output
+};
+
+// the mutable state of a transform, made by a processor's make_workspace and only for that processor, or
+// another of the same width and precision.
+//
+struct IFFTWorkspace
+{
+	virtual ~IFFTWorkspace() {};
+};
+
+// an implementation need only provide the fp_t operator and width, the rest have defaults that
+// work through them, or refuse. 'using IProcessorFFT::operator();' keeps the others callable on it.
+//
 struct IProcessorFFT
 {
 public:
 	virtual ~IProcessorFFT() {};
 	virtual std::pair<fp_t const*, fp_t const*> operator () (fp_t const* ib, fp_t const* ie) = 0;
+	// integer PCM, full scale reading as 1.0 does, converted as it is windowed. The defaults convert
+	// the frame to fp_t first, then use the operator above.
+	virtual std::pair<fp_t const*, fp_t const*> operator () (int16_t const* ib, int16_t const* ie);
+	virtual std::pair<fp_t const*, fp_t const*> operator () (pcm24_t const* ib, pcm24_t const* ie);
+	virtual std::pair<fp_t const*, fp_t const*> operator () (int32_t const* ib, int32_t const* ie);
 	virtual size_t width() = 0;
+
+	// a frame shorter than width() is taken as those samples followed by zeros. The window is stretched
+	// over the samples, each taking the coefficient nearest the centre of its share of the window, and
+	// the scaling follows from their sum, so a sine still reads its amplitude. Only bins [first, last)
+	// are computed, the rest read 0. The butterflies that only ever see zeros, or only feed bins outside
+	// the range, are skipped. prune(0, width() / 2) to undo. The default ignores the range and computes
+	// every bin.
+	virtual void prune(size_t /*first*/, size_t /*last*/) {}
+
+	// enabling clears the counters. Disabled the cost is a test per frame. The defaults count nothing.
+	virtual void enable_stats(bool /*enable*/) {}
+	virtual fft_stats_t stats() const { return {}; }
+
+	// reentrant. The window, twiddles, gain and range are only read and everything a transform writes is in 'ws',
+	// so any number of threads may share one processor, each with its own workspace. The results are in 'ws', good
+	// until it is next used. Stats are not counted, and prune() and the operators above aren't reentrant, so
+	// prune before sharing. A workspace of another width or precision throws std::invalid_argument.
+	// By default a processor isn't reentrant, make_workspace returns null and these throw std::logic_error.
+	virtual std::unique_ptr<IFFTWorkspace> make_workspace() const { return nullptr; }
+	virtual std::pair<fp_t const*, fp_t const*> execute(fp_t const* ib, fp_t const* ie, IFFTWorkspace& ws) const;
+	virtual std::pair<fp_t const*, fp_t const*> execute(int16_t const* ib, int16_t const* ie, IFFTWorkspace& ws) const;
+	virtual std::pair<fp_t const*, fp_t const*> execute(pcm24_t const* ib, pcm24_t const* ie, IFFTWorkspace& ws) const;
+	virtual std::pair<fp_t const*, fp_t const*> execute(int32_t const* ib, int32_t const* ie, IFFTWorkspace& ws) const;
+	// as above with a workspace from the processor's pool, which grows to as many as are in use at once,
+	// so one per thread. The width() / 2 magnitudes are copied to 'out'. The defaults make a workspace
+	// for each call, so throw std::logic_error as above if there are none.
+	virtual void execute(fp_t const* ib, fp_t const* ie, fp_t* out) const;
+	virtual void execute(int16_t const* ib, int16_t const* ie, fp_t* out) const;
+	virtual void execute(pcm24_t const* ib, pcm24_t const* ie, fp_t* out) const;
+	virtual void execute(int32_t const* ib, int32_t const* ie, fp_t* out) const;
 };
 
 
@@ -31,11 +102,377 @@ std::string_view wt_to_string(window_t wt);
 const size_t FFTWdMin = 8;
 const size_t FFTWdMax = 24;
 
+// ESTIMATE uses the wisdom for the width and precision if there is some, otherwise a fixed default. No measurement, so construction is quick.
+// MEASURE  uses the wisdom for the width and precision if there is some, otherwise times the candidate kernels, keeps the fastest and
+//          records it as wisdom for subsequent processors.
+enum class plan_t { ESTIMATE, MEASURE };
+
+// SINGLE is fp_t throughout.
+// DOUBLE windows, transforms and takes magnitudes in double, rounding the results to fp_t. Half the speed, or
+//        less, for a noise floor well below anything fp_t can represent.
+// MIXED  keeps the data in fp_t but the twiddles and the butterflies' arithmetic in double, two stages to a pass
+//        so the data is rounded once for each pair. Its error is a few dB above DOUBLE's, its cost about DOUBLE's
+//        from 2^13 to 2^15 points and less above, near SINGLE's from 2^17. There are no mixed codelets, so up to
+//        4096 points it runs the radix-2 stages and is slower than DOUBLE, which has them.
+// FIXED  windows in fp_t, then transforms in 16 bit block floating point, so twice the lanes of SINGLE's in each
+//        vector register. A plan_t has no effect. The noise floor is about 60dB below a broadband signal's level,
+//        and a pure tone's SNR is at least 79 - 3 * width dB, the worst case.
+// None has kernels written for a particular vector unit, each is code the compiler vectorises for its types.
+enum class precision_t { SINGLE, DOUBLE, MIXED, FIXED };
+
 // creates an FFT processor with the specified width and using the specified windowint function.
 // width is the power of 2 of the FFTSZ, to avoid complications.
 // currently  between FFTWdMin and FFTWinMax, inclusive.
+// Wisdom is kept per width and precision, so each precision measures and records its own.
+// Widths 8 to 12 in SINGLE and DOUBLE run codelets that have no strategy, so MEASURE has nothing to time there.
+// FIXED has a single kernel, so it ignores plan_t, MEASURE included, and wisdom.
+//
+std::unique_ptr<IProcessorFFT> make_fft(size_t width, window_t wt, plan_t pt = plan_t::ESTIMATE, precision_t pr = precision_t::SINGLE);
+
+// whether MEASURE has kernels to choose between for the width and precision, and so records wisdom.
+// False for a width out of range.
+bool can_measure(size_t width, precision_t pr);
+
+// wisdom is process wide. load merges the contents of the file with what is already known,
+// save writes everything known. Both return false on failure, a file that isn't wisdom is a failure.
+// Files from before wisdom had a precision load as SINGLE's.
+//
+bool load_wisdom(char const* path);
+bool save_wisdom(char const* path);
+void forget_wisdom();
+
+// processors, their workspaces and the twiddle and window tables come from an arena of 64 byte aligned blocks.
+// Blocks of 2MB and more are mapped on their own, aligned to 2MB, and backed by huge pages as asked.
+// NONE       ordinary pages.
+// TRANSPARENT advises the kernel to use huge pages (MADV_HUGEPAGE), the default.
+// HUGETLB    maps from the reserved huge page pool, 1GB pages for multiples of 1GB, falling back to TRANSPARENT when
+//            there aren't enough reserved. Windows only takes ordinary pages.
+// Freed blocks are kept, up to 'pool_bytes' of them, default 256MB, for the next processor of the same size, so
+// processors made and destroyed over and over reuse memory that is already faulted in. 0 releases them all.
+//
+enum class huge_pages_t { NONE, TRANSPARENT, HUGETLB };
+void configure_arena(huge_pages_t hp, size_t pool_bytes);
+
+struct arena_stats_t
+{
+	uint64_t allocated_bytes; // in use, rounded up to the block sizes
+	uint64_t pooled_bytes;    // freed and kept
+	uint64_t fresh;           // allocations the pool couldn't meet
+	uint64_t reused;          // allocations it could
+	uint64_t hugetlb_blocks;  // blocks mapped from the reserved pool
+};
+arena_stats_t arena_stats();
+
+// magnitude spectra of each channel of interleaved multi channel input.
+// sample n of channel c of a frame is ib[n * stride() + c], so a frame spans
+// (width() - 1) * stride() + channels() samples. The result is width() / 2
+// magnitudes for each channel in turn, scaled as IProcessorFFT.
+//
+struct IProcessorFFTMulti
+{
+public:
+	virtual ~IProcessorFFTMulti() {};
+	virtual std::pair<fp_t const*, fp_t const*> operator () (fp_t const* ib, fp_t const* ie) = 0;
+	// integer PCM as IProcessorFFT.
+	virtual std::pair<fp_t const*, fp_t const*> operator () (int16_t const* ib, int16_t const* ie) = 0;
+	virtual std::pair<fp_t const*, fp_t const*> operator () (pcm24_t const* ib, pcm24_t const* ie) = 0;
+	virtual std::pair<fp_t const*, fp_t const*> operator () (int32_t const* ib, int32_t const* ie) = 0;
+	virtual size_t width() = 0;
+	virtual size_t channels() = 0;
+	virtual size_t stride() = 0;
+
+	// as IProcessorFFT, frames count each channel transformed.
+	virtual void enable_stats(bool enable) = 0;
+	virtual fft_stats_t stats() const = 0;
+};
+
+// width and window as make_fft, stride is the distance in samples between successive samples of
+// a channel, 0 meaning 'channels', otherwise at least 'channels'. Uses wisdom for the width if there is some.
+//
+std::unique_ptr<IProcessorFFTMulti> make_fft_multi(size_t width, window_t wt, size_t channels, size_t stride = 0);
+
+// two channel analysis. x is the reference, the input to a system, and y its output.
+// Each call takes one frame of width() samples of each channel, sample n of x at xb[n * stride],
+// and adds it to Welch averages of the auto and cross spectra. For interleaved x,y pairs
+// pass p, p + 1 and stride 2. Results are for bins [0, width() / 2), the auto spectra
+// scaled so their square roots are the magnitudes IProcessorFFT would give.
+//
+struct IProcessorCrossFFT
+{
+public:
+	virtual ~IProcessorCrossFFT() {};
+	virtual void operator () (fp_t const* xb, fp_t const* yb, size_t stride = 1) = 0;
+	virtual void reset() = 0;
+	virtual size_t frames() = 0;
+	virtual size_t width() = 0;
+
+	virtual void auto_spectra(fp_t* gxx, fp_t* gyy) = 0;
+	virtual void cross_spectrum(std::complex<fp_t>* gxy) = 0;
+	// H1 = Gxy / Gxx, H2 = Gyy / Gyx and coherence |Gxy|^2 / (Gxx Gyy).
+	virtual void h1(std::complex<fp_t>* h) = 0;
+	virtual void h2(std::complex<fp_t>* h) = 0;
+	virtual void coherence(fp_t* c) = 0;
+};
+
+// width and window as make_fft. Uses wisdom for the width if there is some.
+//
+std::unique_ptr<IProcessorCrossFFT> make_cross_fft(size_t width, window_t wt);
+
+// zoom FFT, high resolution over a narrow band. The band about 'centre' is mixed down, low pass
+// filtered and decimated by 'decimation', then transformed. The result is width() magnitudes, lowest
+// frequency first, bin k at bin_frequency(k), spaced sample_rate / (decimation * width()) apart and
+// covering centre +/- sample_rate / decimation / 2, scaled as IProcessorFFT. The outer tenth or so
+// at each end is in the transition band of the decimating filter. Each frame consumes span() input
+// samples, successive frames overlap by half when started width() * decimation() / 2 apart.
+//
+struct IProcessorZoomFFT
+{
+public:
+	virtual ~IProcessorZoomFFT() {};
+	virtual std::pair<fp_t const*, fp_t const*> operator () (fp_t const* ib, fp_t const* ie) = 0;
+	virtual size_t width() = 0;
+	virtual size_t span() = 0;
+	virtual size_t decimation() = 0;
+	virtual double bin_frequency(size_t k) = 0;
+};
+
+// width and window as make_fft, sample_rate and centre in Hz, decimation at least 1.
+//
+std::unique_ptr<IProcessorZoomFFT> make_zoom_fft(size_t width, window_t wt, double sample_rate, double centre, size_t decimation);
+
+// two dimensional transforms, rows by columns of row major data, computed row-column.
+// complex input gives the complex spectrum, rows * cols, row major.
+// real input gives the non-redundant half spectrum, rows * (cols / 2 + 1), row major.
+// Forward transforms, unscaled.
+//
+struct IProcessorFFT2D
+{
+public:
+	virtual ~IProcessorFFT2D() {};
+	virtual void operator () (std::complex<fp_t> const* in, std::complex<fp_t>* out) = 0;
+	virtual void operator () (fp_t const* in, std::complex<fp_t>* out) = 0;
+	virtual size_t rows() = 0;
+	virtual size_t cols() = 0;
+};
+
+// rows = 2^rows_width, cols = 2^cols_width, each between FFTWdMin and FFTWdMax inclusive.
+//
+std::unique_ptr<IProcessorFFT2D> make_fft2d(size_t rows_width, size_t cols_width);
+
+// autocorrelation and real cepstrum, by FFT. Batched, 'frames' frames of frame() samples 'hop' apart
+// from ib, lags() values for each written in turn to 'out'.
+// make_autocorrelation, frames of 2^width samples, zero padded to twice that so there is no circular
+// wrap. Lags 0 to frame() - 1 of sum over n of x[n] * x[n + lag], windowed first if wt isn't NOWINDOW.
+// make_cepstrum, frames of 2^width samples, windowed. Quefrencies 0 to frame() / 2 - 1 of the real
+// cepstrum, the inverse transform of ln|X|, the rest being its mirror image.
+//
+struct IProcessorCorrelation
+{
+public:
+	virtual ~IProcessorCorrelation() {};
+	virtual void operator () (fp_t const* ib, size_t frames, size_t hop, fp_t* out) = 0;
+	virtual size_t frame() = 0;
+	virtual size_t lags() = 0;
+};
+
+// width between FFTWdMin and FFTWdMax - 1 inclusive, the transforms being twice as wide.
+std::unique_ptr<IProcessorCorrelation> make_autocorrelation(size_t width, window_t wt = window_t::NOWINDOW);
+// width as make_fft.
+std::unique_ptr<IProcessorCorrelation> make_cepstrum(size_t width, window_t wt = window_t::HAMMING);
+
+// multitaper spectra, Thomson's low variance estimate. Each frame of width() samples is read once, tapered by
+// each of tapers() discrete prolate spheroidal (Slepian) sequences of time-bandwidth nw, transformed two tapers
+// at a time, and the eigenspectra combined with adaptive weights. The resolution is +/- nw bins. The values are
+// the square roots of the power in each bin, so their squares sum to the frame's mean square, and white noise of
+// variance s^2 reads s * sqrt(2 / width()). The tapers are computed once for each width, nw and K and shared.
+//
+struct IProcessorMultitaper
+{
+public:
+	virtual ~IProcessorMultitaper() {};
+	virtual std::pair<fp_t const*, fp_t const*> operator () (fp_t const* ib, fp_t const* ie) = 0;
+	virtual size_t width() = 0;
+	virtual size_t tapers() = 0;
+	// the fraction of taper k's energy within the band, close to 1 for the first 2nw - 1.
+	virtual double concentration(size_t k) = 0;
+};
+
+// width as make_fft, nw at least 1, tapers 0 for 2nw - 1 and no more than 2nw. Empty if they aren't.
+std::unique_ptr<IProcessorMultitaper> make_multitaper(size_t width, double nw = 4.0, size_t tapers = 0);
+
+// FIR filtering by uniformly partitioned overlap-save convolution, for kernels of any length. Each call
+// takes block() samples, 2^width, 'stride' apart, and writes the next block() samples of the kernel
+// convolved with everything in so far to 'out', the same stride, which may be 'in'. The first output
+// sample is kernel[0] * in[0], there is no delay. The work per sample is two transforms of 2^width
+// per 2^width samples plus a product per partition of 2^(width - 1) taps, so longer kernels want wider.
+// clone() is another, reset, for another channel or thread, sharing the kernel's spectra.
+//
+struct IConvolver
+{
+public:
+	virtual ~IConvolver() {};
+	virtual void operator () (fp_t const* in, fp_t* out, size_t stride = 1) = 0;
+	virtual size_t block() = 0;
+	virtual size_t partitions() = 0;
+	// as new, no history.
+	virtual void reset() = 0;
+	virtual std::unique_ptr<IConvolver> clone() const = 0;
+};
+
+// width as make_fft, the kernel is [kernel_b, kernel_e).
+std::unique_ptr<IConvolver> make_convolver(size_t width, fp_t const* kernel_b, fp_t const* kernel_e);
+
+// the analytic signal x + iH(x), H the Hilbert transform, streaming. Each call takes block() samples,
+// 2^width, and writes the analytic signal of block() samples to 'z', and if they aren't null, its
+// magnitude, the instantaneous amplitude, to 'amplitude' and the instantaneous frequency in cycles per
+// sample to 'frequency'. Output runs delay() samples behind input, about a quarter of block(), the
+// Hilbert kernel's half length. It is flat to within 0.001% from about 16 / block() cycles per sample to
+// as far short of half the sample rate. Nothing is allocated once made.
+//
+struct IAnalyticSignal
+{
+public:
+	virtual ~IAnalyticSignal() {};
+	virtual void operator () (fp_t const* in, std::complex<fp_t>* z, fp_t* amplitude, fp_t* frequency) = 0;
+	virtual size_t block() = 0;
+	virtual size_t delay() = 0;
+	// as new, no history.
+	virtual void reset() = 0;
+};
+
+// width as make_fft.
+std::unique_ptr<IAnalyticSignal> make_analytic_signal(size_t width);
+
+// peaks in a magnitude spectrum such as IProcessorFFT gives. The strongest local maxima above 'threshold',
+// strongest first, none within 'min_separation' bins of a stronger one, at most 'max_peaks' of them written
+// to 'out'. Returns how many. Each is refined using the shape of the window's main lobe, so for a steady
+// sine 'bin' is its frequency in bins, fractional, and 'magnitude' its amplitude, measured within 1.1e-3
+// bins and 3e-4 of the amplitude for every window from 2^10 to 2^16 points. Make the finder with the
+// window the spectrum was made with.
+//
+struct peak_t
+{
+	double bin;
+	fp_t   magnitude;
+};
+
+struct IPeakFinder
+{
+public:
+	virtual ~IPeakFinder() {};
+	virtual size_t operator () (fp_t const* b, fp_t const* e, fp_t threshold, size_t min_separation, peak_t* out, size_t max_peaks) = 0;
+};
+
+std::unique_ptr<IPeakFinder> make_peak_finder(window_t wt);
+
+// constant-Q transform, bins spaced geometrically, bins_per_octave of them, from f_min to f_max, each
+// as wide as its spacing. One FFT of width() per frame and a sparse product with precomputed spectral
+// kernels. Magnitudes scaled as IProcessorFFT, a sine of amplitude A at a bin's frequency reads A.
+// A frame is width() samples, one shorter is taken as those samples followed by zeros, unscaled, so the
+// kernels that reach past its end read less. Samples beyond width() are ignored. The batch form transforms
+// 'frames' whole frames 'hop' apart, two per FFT, and writes bins() magnitudes for each in turn to 'out'.
+//
+struct IProcessorCQT
+{
+public:
+	virtual ~IProcessorCQT() {};
+	virtual std::pair<fp_t const*, fp_t const*> operator () (fp_t const* ib, fp_t const* ie) = 0;
+	virtual void operator () (fp_t const* ib, size_t frames, size_t hop, fp_t* out) = 0;
+	virtual size_t width() = 0;
+	virtual size_t bins() = 0;
+	virtual double bin_frequency(size_t k) = 0;
+	// coefficients kept in the kernels, the multiply-adds per frame.
+	virtual size_t kernel_size() = 0;
+};
+
+// frequencies in Hz, f_max no more than half the sample rate. The width is the smallest that holds the
+// lowest bin's kernel, Q / f_min seconds, Q = 1 / (2^(1 / bins_per_octave) - 1). Empty if that is beyond FFTWdMax.
+//
+std::unique_ptr<IProcessorCQT> make_cqt(double sample_rate, double f_min, double f_max, size_t bins_per_octave, window_t wt = window_t::HAMMING);
+
+// live analysis from a capture thread. Samples pushed are cut into frames of width() overlapping by half,
+// each transformed on one of the worker threads, and the spectra, width() / 2 magnitudes scaled as
+// IProcessorFFT, come out in order. push is for one producer thread, front and release for one consumer
+// thread, neither ever waits, locks or allocates. A frame that finds its worker's ring full is dropped and
+// counted as an overrun. While the workers keep up a frame's spectrum is ready at most one hop after its
+// first new sample arrives, plus the transform, plus the 100us an idle worker may be napping.
+//
+struct pipeline_stats_t
+{
+	uint64_t frames;			// transformed
+	uint64_t overruns;			// dropped for want of room
+	uint64_t max_latency_ns;	// worst from the last sample of a frame arriving to its spectrum being ready
+};
+
+struct IPipelineFFT
+{
+public:
+	virtual ~IPipelineFFT() {};
+	virtual void push(fp_t const* b, fp_t const* e) = 0;
+	// the next spectrum in order, valid until release, or nullptr if there isn't one yet.
+	virtual fp_t const* front() = 0;
+	virtual void release() = 0;
+	// every frame pushed so far has been released, for the consumer to know it is done.
+	virtual bool drained() = 0;
+	virtual size_t width() = 0;
+	// safe from any thread.
+	virtual pipeline_stats_t stats() const = 0;
+};
+
+// width and window as make_fft, 'workers' threads, 'depth' frames queued in each direction for each worker.
+//
+std::unique_ptr<IPipelineFFT> make_fft_pipeline(size_t width, window_t wt, size_t workers = 1, size_t depth = 8);
+
+// asynchronous spectra for many concurrent callers, on a shared pool of workers. Each worker takes its own
+// newest task first and, with none, steals the oldest of another's, always at the highest priority anyone
+// has queued. Processors are made once per width and window and shared by every worker, each transforming
+// in its own workspace, so a request costs a task, not a thread or a plan. A frame's result is its magnitude
+// spectrum, scaled as IProcessorFFT; a buffer's is the mean of its half overlapped frames', the frames split
+// into pieces that any idle worker may take. Submitting is safe from any thread, a worker's included.
+//
+enum class fft_priority_t { HIGH, NORMAL, LOW };
+
+// FAILED if the width is out of range or a buffer is shorter than a frame.
+enum class fft_status_t { DONE, CANCELLED, FAILED };
+
+struct fft_result_t
+{
+	fft_status_t status;
+	size_t frames;                // transformed
+	std::vector<fp_t> magnitudes; // width / 2 when DONE
+};
+
+// cancel() skips whatever hasn't started, the result then says CANCELLED unless it was already DONE.
+struct fft_request_t
+{
+	std::future<fft_result_t> result;
+	std::shared_ptr<std::atomic<bool>> cancelled;
+	void cancel() { cancelled->store(true, std::memory_order_relaxed); }
+};
+
+struct service_stats_t
+{
+	uint64_t tasks;     // run, pieces of buffers counted singly
+	uint64_t stolen;    // of those, taken from another worker's queue
+	uint64_t completed; // requests DONE
+	uint64_t cancelled; // requests CANCELLED
+	uint64_t plans;     // processors made
+};
+
+struct IFFTService
+{
+public:
+	// finishes everything queued first.
+	virtual ~IFFTService() {};
+	virtual fft_request_t submit_frame(size_t width, window_t wt, std::vector<fp_t> frame, fft_priority_t pr = fft_priority_t::NORMAL) = 0;
+	virtual fft_request_t submit_buffer(size_t width, window_t wt, std::vector<fp_t> samples, fft_priority_t pr = fft_priority_t::NORMAL) = 0;
+	virtual size_t workers() = 0;
+	virtual service_stats_t stats() const = 0;
+};
+
+// 'workers' threads, 0 for one per hardware thread.
 //
-std::unique_ptr<IProcessorFFT> make_fft(size_t width, window_t wt);
+std::unique_ptr<IFFTService> make_fft_service(size_t workers = 0);
 
 // f = frequency in Hz
 // sample_rate = sample rate in Hz, 44100, 96000 etc.
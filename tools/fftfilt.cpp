@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "fftlib.h"
+#include "mm_file.h"
+#include "mm_out_file.h"
+
+using stats_clock = std::chrono::steady_clock;
+
+void Welcome()
+{
+	std::cerr << "FFTfilt 1.00 Copyright Paul Ranson (c) 2009-2022\n";
+	std::cerr << "email - paul@epicyclism.com\n\n";
+	std::cerr << "Filters a file of raw sample data with an FIR kernel by FFT convolution\n";
+	std::cerr << "(sizeof fp type is " << sizeof(fp_t) << ")\n\n";
+}
+
+void Usage()
+{
+	std::cerr << "Usage : FFTfilt [-Fn] [-Cn] [-Tn] [-A] <input file> <kernel file> <output file>\n";
+	std::cerr << "Where input and kernel files are packed arrays of floats, and the output is written the same way.\n";
+	std::cerr << "Options. -Fn, use an FFT width of 2^n, each block and kernel partition is half that.\n";
+	std::cerr << "              Default is the smallest that holds the kernel in 8 partitions, 10 to 16.\n";
+	std::cerr << "         -Cn, the input has n interleaved channels, default 1. Each is filtered by the\n";
+	std::cerr << "              same kernel and the output is interleaved the same way.\n";
+	std::cerr << "         -Tn, filter on n threads, default one per hardware thread. Channels, and\n";
+	std::cerr << "              stretches of each channel, are shared between them.\n";
+	std::cerr << "         -A,  append the tail, the output is longer than the input by the kernel less one.\n";
+	std::cerr << "              Otherwise it is the same length.\n\n";
+}
+
+int main(int argc, char* argv[])
+{
+	Welcome();
+
+	size_t fftWidth = 0;
+	size_t channels = 1;
+	size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	bool   bTail = false;
+	char const* files[3] = {};
+	int    nFiles = 0;
+
+	int		arg = 1;
+	while (arg < argc)
+	{
+		if (argv[arg][0] == '-' || argv[arg][0] == '/')
+		{
+			switch (argv[arg][1])
+			{
+			case 'F':
+			case 'f':
+				fftWidth = atoi(argv[arg] + 2);
+				break;
+			case 'C':
+			case 'c':
+				channels = atoi(argv[arg] + 2);
+				break;
+			case 'T':
+			case 't':
+				threads = atoi(argv[arg] + 2);
+				break;
+			case 'A':
+			case 'a':
+				bTail = true;
+				break;
+			default:
+				std::cerr << "Unknown argument \'" << argv[arg][1] << "\'!\n";
+				Usage();
+				return -1;
+			}
+		}
+		else
+		if (nFiles < 3)
+			files[nFiles++] = argv[arg];
+		++arg;
+	}
+	if (nFiles != 3 || channels == 0 || threads == 0)
+	{
+		Usage();
+		return -1;
+	}
+	mem_map_file<fp_t> in(files[0]);
+	if (!in)
+	{
+		std::cerr << "Couldn't open <" << files[0] << ">\n";
+		return -1;
+	}
+	mem_map_file<fp_t> kernel(files[1]);
+	if (!kernel || kernel.length() == 0)
+	{
+		std::cerr << "Couldn't open kernel <" << files[1] << ">, or it is empty\n";
+		return -1;
+	}
+	size_t const taps = kernel.length();
+	if (fftWidth == 0)
+	{
+		// wider transforms cost more per sample, and so do more partitions, 8 is about the balance.
+		fftWidth = 10;
+		while (fftWidth < 16 && (size_t(1) << (fftWidth - 1)) * 8 < taps)
+			++fftWidth;
+	}
+	if (fftWidth < FFTWdMin || fftWidth > FFTWdMax)
+	{
+		std::cerr << "FFTWidth provided is out of range, valid between" << FFTWdMin << " and " << FFTWdMax << " inclusive.\n";
+		Usage();
+		return -1;
+	}
+
+	// in samples of each channel.
+	size_t const length = in.length() / channels;
+	size_t const outLength = length + (bTail ? taps - 1 : 0);
+	mem_map_out_file<fp_t> out(files[2], outLength * channels, true);
+	if (!out)
+	{
+		std::cerr << "Couldn't open output file <" << files[2] << ">\n";
+		return -1;
+	}
+	out.advise(mm_advice_t::SEQUENTIAL);
+
+	auto const t_start = stats_clock::now();
+	auto proto = make_convolver(fftWidth, kernel.begin(), kernel.end());
+	size_t const block = proto->block();
+	size_t const blocks = (outLength + block - 1) / block;
+	// a stretch that doesn't start at the beginning starts this many blocks early, for the kernel's history.
+	size_t const warm = (taps - 1 + block - 1) / block;
+	// enough stretches of each channel to keep every thread busy, none of them mostly warming up.
+	size_t const stretches = std::max<size_t>(1, std::min((threads + channels - 1) / channels, blocks / (4 * (warm + 1))));
+	size_t const units = channels * stretches;
+	threads = std::min(threads, units);
+
+	std::cerr << "FFTfilt. Filtering,  width " << (size_t(1) << fftWidth) << ", " << taps << " taps in " << proto->partitions() << " partitions, "
+		<< channels << (channels > 1 ? " channels" : " channel") << ", " << threads << " threads\n";
+
+	std::atomic<size_t> next{ 0 };
+	auto worker = [&]()
+	{
+		auto conv = proto->clone();
+		std::vector<fp_t> tin(block);
+		std::vector<fp_t> tout(block);
+		for (size_t u = next++; u < units; u = next++)
+		{
+			size_t const c = u % channels;
+			size_t const s = u / channels;
+			size_t const bb = blocks * s / stretches;
+			size_t const be = blocks * (s + 1) / stretches;
+			conv->reset();
+			for (size_t b = bb > warm ? bb - warm : 0; b < be; ++b)
+			{
+				size_t const n0 = b * block;
+				if (b >= bb && n0 + block <= std::min(length, outLength))
+				{
+					(*conv) (in.ptr() + n0 * channels + c, out.ptr() + n0 * channels + c, channels);
+					continue;
+				}
+				// warming up, or off the end of the input or output, through contiguous copies.
+				for (size_t n = 0; n < block; ++n)
+					tin[n] = n0 + n < length ? in.ptr()[(n0 + n) * channels + c] : fp_t(0);
+				(*conv) (tin.data(), tout.data());
+				if (b >= bb)
+					for (size_t n = 0; n < block && n0 + n < outLength; ++n)
+						out.ptr()[(n0 + n) * channels + c] = tout[n];
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; ++t)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& t : pool)
+		t.join();
+
+	double const s = std::chrono::duration<double>(stats_clock::now() - t_start).count();
+	std::cerr << "FFTfilt. " << outLength * channels << " samples in " << s << " s, " << (s > 0 ? outLength * channels / s / 1e6 : 0.0) << " MSamples/s\n";
+
+	return 0;
+}
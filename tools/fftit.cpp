@@ -8,10 +8,30 @@
 #include <cstdlib>
 #include <algorithm>
 #include <functional>
+#include <chrono>
+#include <iomanip>
+#include <numbers>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#if !defined (_WIN32)
+#include <sys/resource.h>
+#endif
 
 #include "fftlib.h"
 #include "mm_file.h"
 
+using stats_clock = std::chrono::steady_clock;
+
+// the sample rate when none is given, bins then written as indices.
+constexpr size_t NoSampleRate = size_t(-1);
+
 void Welcome()
 {
 	std::cerr << "FFTit 2.00 Copyright Paul Ranson (c) 2009-2022\n";
@@ -23,8 +43,10 @@ void Welcome()
 void Usage()
 {
 	std::cerr << "Performs FFTs on a file of raw sample data\n";
-	std::cerr << "Usage : FFTit [-Fn] [-D] [-1] [-Wn] <input file> [sample rate]\n";
+	std::cerr << "Usage : FFTit [-Fn] [-D] [-1] [-Wn] [-Cn] [-X] [-Blo:hi] [-Ln] [-Rlo:hi] [-Qn] [-Nn[:k]] [-Pn[:sep]] [-In] [-Ex] [-Mfile] [-S] [-Tn] <input file>... [@list] [sample rate]\n";
 	std::cerr << "Where input file is a packed array of floats. Output is text to stdout.\n";
+	std::cerr << "More than one input file, or @list naming a file that lists them one per line, is a\n";
+	std::cerr << "batch. Each input's spectrum is then written to the input's name with .txt appended.\n";
 	std::cerr << "Options. -Fn, use an FFT width of 2^n.\n";
 	std::cerr << "              n between 8 for 256 and 24 for 16777216.\n";
 	std::cerr << "              Default is 18 for 262144\n";
@@ -36,11 +58,528 @@ void Usage()
 	std::cerr << "				1 is Hamming and the default.\n";
 	std::cerr << "              2 is Blackman, 3 Blackman-Harris.\n";
 	std::cerr << "              4 is Kaiser5,  5 Kaiser7.\n";
-	std::cerr << "And if you provide the sample rate, the centre frequencies of each bin are written to the output.\n\n";
+	std::cerr << "         -Cn, the input has n interleaved channels, default 1. Each line of\n";
+	std::cerr << "              the output then has the value for each channel in turn.\n";
+	std::cerr << "         -X,  the input is 2 interleaved channels, the input to a system and its\n";
+	std::cerr << "              output. Writes the H1 transfer function, magnitude and phase in\n";
+	std::cerr << "              degrees, and the coherence for each bin.\n";
+	std::cerr << "         -Blo:hi, zoom in on the band lo to hi Hz, the FFT width then applies\n";
+	std::cerr << "              to the narrow band. Needs the sample rate.\n";
+	std::cerr << "         -Ln, frames of n samples zero padded to the FFT width, for short bursts.\n";
+	std::cerr << "         -Rlo:hi, only compute and write the bins from lo to hi Hz, or bin numbers\n";
+	std::cerr << "              without the sample rate. -L and -R skip the work they make needless.\n";
+	std::cerr << "         -Qn, constant-Q spectrum, n bins per octave over the -R range, by default\n";
+	std::cerr << "              27.5Hz to half the sample rate. Needs the sample rate, sets its own width.\n";
+	std::cerr << "         -Nn[:k], multitaper spectrum, k Slepian tapers of time-bandwidth n, default 4 and\n";
+	std::cerr << "              2n - 1, adaptively weighted. Writes the root of each bin's power, so white\n";
+	std::cerr << "              noise reads the same in every bin. Replaces -W. Float input, one channel,\n";
+	std::cerr << "              no peaks.\n";
+	std::cerr << "         -Pn[:sep], write only the n strongest peaks, default 8, at least 'sep' bins\n";
+	std::cerr << "              apart, default 3. Frequency and amplitude refined between bins.\n";
+	std::cerr << "         -In, the input's samples are n bit little endian integer PCM, 16, 24 (packed,\n";
+	std::cerr << "              3 bytes each) or 32, full scale reading as 1.0 does, rather than floats.\n";
+	std::cerr << "              Not with -X, -B or -Q.\n";
+	std::cerr << "         -Ex, the transform's precision. 'f' float throughout and the default, 'd' double\n";
+	std::cerr << "              throughout, 'm' float data with double twiddles and arithmetic, 'x' 16 bit\n";
+	std::cerr << "              block floating point, faster and noisier.\n";
+	std::cerr << "              Results are written as floats whichever. A single channel only.\n";
+	std::cerr << "         -Mfile, measure the fastest kernel for the FFT width unless 'file'\n";
+	std::cerr << "              already knows it, and keep the result in 'file' for next time.\n";
+	std::cerr << "              Not saved where there's no choice, as for -Ex and widths 8 to 12.\n";
+	std::cerr << "         -S,  report where the time went, phase by phase, to stderr.\n";
+	std::cerr << "         -Tn, process a batch on n threads, default one per hardware thread.\n";
+	std::cerr << "And if you provide the sample rate, the centre frequencies of each bin are written to the output.\n";
+	std::cerr << "It's the last argument, a whole number of Hz, so an input named with a leading digit can't be last.\n\n";
+}
+
+// page faults so far, minor and major. Not available everywhere.
+std::pair<long, long> page_faults()
+{
+#if defined (_WIN32)
+	return { 0, 0 };
+#else
+	rusage ru;
+	::getrusage(RUSAGE_SELF, &ru);
+	return { ru.ru_minflt, ru.ru_majflt };
+#endif
+}
+
+double to_ms(stats_clock::duration d)
+{
+	return std::chrono::duration<double, std::milli>(d).count();
+}
+
+void ReportStats(fft_stats_t const& st, size_t sample_bytes, stats_clock::duration map_t, stats_clock::duration make_t, stats_clock::duration average_t,
+				stats_clock::duration output_t, stats_clock::duration total_t, std::pair<long, long> faults)
+{
+	auto const window_t = std::chrono::nanoseconds(st.window_ns);
+	auto const fft_t = std::chrono::nanoseconds(st.fft_ns);
+	auto const mag_t = std::chrono::nanoseconds(st.magnitude_ns);
+	auto line = [total = to_ms(total_t)](char const* phase, stats_clock::duration d)
+	{
+		std::cerr << "  " << std::left << std::setw(12) << phase << std::right << std::setw(12) << to_ms(d) << " ms "
+			<< std::setw(6) << (total > 0 ? 100.0 * to_ms(d) / total : 0.0) << " %\n";
+	};
+	std::cerr << std::fixed << std::setprecision(3);
+	std::cerr << "FFTit. Stats\n";
+	line("map", map_t);
+	line("construct", make_t);
+	line("window", window_t);
+	line("fft", fft_t);
+	line("magnitude", mag_t);
+	line("average", average_t);
+	line("output", output_t);
+	line("total", total_t);
+	std::cerr << "  frames " << st.frames << ", input " << st.bytes / 1048576.0 << " MB, page faults while processing "
+		<< faults.first << " minor " << faults.second << " major (counted in window)\n";
+	double const proc_s = std::chrono::duration<double>(window_t + fft_t + mag_t).count();
+	if (proc_s > 0)
+	{
+		std::cerr << "  processing " << st.frames / proc_s << " frames/s, "
+			<< st.bytes / sample_bytes / proc_s / 1e6 << " MSamples/s, "
+			<< st.bytes / proc_s / 1e6 << " MB/s\n";
+	}
+	std::cerr << std::defaultfloat;
+}
+
+// 50% overlapped frames of 'width' in 'length' samples, 0 if there isn't enough for one.
+size_t frame_count(size_t length, size_t width)
+{
+	if (length >= width * 3 / 2)
+		return length / (width / 2) - 1;
+	if (length > width)
+		return 1;
+	return 0;
+}
+
+// the bins from 'lo' to 'hi' Hz, or bin numbers without the sample rate, as [binLo, binHi).
+std::pair<size_t, size_t> bin_range(size_t width, size_t sample_rate, bool bRange, double lo, double hi)
+{
+	size_t binLo = 0;
+	size_t binHi = width / 2;
+	if (bRange)
+	{
+		double const perBin = sample_rate != NoSampleRate ? double(sample_rate) / width : 1.0;
+		binLo = std::min(binHi, static_cast<size_t>(std::ceil(lo / perBin)));
+		binHi = std::min(binHi, static_cast<size_t>(std::floor(hi / perBin)) + 1);
+	}
+	return { binLo, binHi };
+}
+
+// the mean of the magnitudes of 50% overlapped frames of 'frame' samples through 'length',
+// or of the centre frame alone if bOnce. 'transform' gives the magnitudes of the frame at sample n.
+// false if there isn't enough signal for one frame.
+template<typename F> bool Average(F transform, size_t length, size_t frame, bool bOnce, std::vector<fp_t>& mean, bool bStats, stats_clock::duration& average_t)
+{
+	if (bOnce)
+	{
+		if (length < frame)
+			return false;
+		size_t offset = (length - frame) / 2;
+		// just a single effort
+		auto[ob, oe] = transform(offset);
+		std::copy(ob, oe, mean.begin());
+	}
+	else
+	{
+		// 50% overlap
+		size_t nffts = frame_count(length, frame);
+		if (nffts == 0)
+			return false;
+
+		for (size_t n = 0; n < nffts; ++n)
+		{
+			auto[ob, oe] = transform(n * frame / 2);
+			// add to average
+			auto const ta = bStats ? stats_clock::now() : stats_clock::time_point();
+			std::transform(mean.begin(), mean.end(), ob, mean.begin(), std::plus<>());
+			if (bStats)
+				average_t += stats_clock::now() - ta;
+		}
+		auto const ta = stats_clock::now();
+		using namespace std::placeholders;
+		std::transform(mean.begin(), mean.end(), mean.begin(), std::bind(std::divides<fp_t>(), _1, fp_t(nffts)));
+		average_t += stats_clock::now() - ta;
+	}
+	return true;
+}
+
+// the bins [binLo, binHi) of each channel's spectrum in 'mean', or the first channel's peaks if nPeaks.
+void WriteSpectrum(std::ostream& os, std::vector<fp_t> const& mean, size_t width, size_t channels, size_t binLo, size_t binHi,
+				size_t sample_rate, bool bDB, window_t wt, size_t nPeaks, size_t peakSep)
+{
+	if (nPeaks != 0)
+	{
+		// the first channel's, within the range.
+		auto pfind = make_peak_finder(wt);
+		std::vector<peak_t> peaks(nPeaks);
+		peaks.resize((*pfind) (mean.data() + binLo, mean.data() + binHi, fp_t(0), peakSep, peaks.data(), nPeaks));
+		for (auto const& p : peaks)
+		{
+			fp_t out = bDB ? fp_t(20.0) * log10(p.magnitude) : p.magnitude;
+			os << (sample_rate != NoSampleRate ? (p.bin + binLo) * sample_rate / width : p.bin + binLo) << " " << out << "\n";
+		}
+	}
+	else
+	{
+		double fbinc = double(sample_rate) / width;
+		double fb = binLo * fbinc;
+		for (size_t i = binLo; i < binHi; ++i)
+		{
+			if (sample_rate != NoSampleRate)
+			{
+				os << fb << " ";
+				fb += fbinc;
+			}
+			for (size_t c = 0; c < channels; ++c)
+			{
+				fp_t out;
+				if (bDB)
+					out = fp_t(20.0) * log10(mean[c * width / 2 + i]);
+				else
+					out = mean[c * width / 2 + i];
+				os << (c ? " " : "") << out;
+			}
+			os << "\n";
+		}
+	}
+}
+
+// how the input's samples are stored.
+enum class format_t { FP, S16, S24, S32 };
+
+size_t sample_bytes(format_t f)
+{
+	switch (f)
+	{
+	case format_t::S16:
+		return 2;
+	case format_t::S24:
+		return 3;
+	case format_t::S32:
+		return 4;
+	default:
+		return sizeof(fp_t);
+	}
+}
+
+template<typename S> std::pair<fp_t const*, fp_t const*> Frame(IProcessorFFT* pfft, IProcessorFFTMulti* pmulti, IFFTWorkspace* ws, S const* b, size_t count)
+{
+	if (pfft && ws)
+		return pfft->execute(b, b + count, *ws);
+	return pfft ? (*pfft) (b, b + count) : (*pmulti) (b, b + count);
+}
+
+// 'count' samples from sample 'n' of the input, as they are stored, through whichever processor there is,
+// in 'ws' if there is one.
+std::pair<fp_t const*, fp_t const*> Frame(IProcessorFFT* pfft, IProcessorFFTMulti* pmulti, mem_map_file<fp_t> const& mmf, format_t f, size_t n, size_t count, IFFTWorkspace* ws = nullptr)
+{
+	switch (f)
+	{
+	case format_t::S16:
+		return Frame(pfft, pmulti, ws, mmf.ptrT<int16_t>(n * 2), count);
+	case format_t::S24:
+		return Frame(pfft, pmulti, ws, mmf.ptrT<pcm24_t>(n * 3), count);
+	case format_t::S32:
+		return Frame(pfft, pmulti, ws, mmf.ptrT<int32_t>(n * 4), count);
+	default:
+		return Frame(pfft, pmulti, ws, mmf.ptr() + n, count);
+	}
+}
+
+// transfer function of the system whose input is the first of the two interleaved channels
+// and output the second.
+int CrossSpectrum(mem_map_file<fp_t> const& mmf, size_t fftWidth, window_t wt, size_t sample_rate, bool bDB, bool bOnce)
+{
+	auto pcross = make_cross_fft(fftWidth, wt);
+	size_t const width = pcross->width();
+	size_t const length = mmf.length() / 2;
+
+	std::cerr << "FFTit. Transfer function,  width " << width << ", window " << wt_to_string(wt) << "\n";
+	size_t nffts = frame_count(length, width);
+	if (nffts == 0)
+	{
+		std::cerr << "Insufficient signal supplied for the specified FFT width\n";
+
+		return -1;
+	}
+	if (bOnce)
+	{
+		fp_t const* p = mmf.ptr() + (length - width) / 2 * 2;
+		(*pcross) (p, p + 1, 2);
+	}
+	else
+	{
+		for (size_t n = 0; n < nffts; ++n)
+		{
+			fp_t const* p = mmf.ptr() + n * width / 2 * 2;
+			(*pcross) (p, p + 1, 2);
+		}
+	}
+	std::vector<std::complex<fp_t>> h(width / 2);
+	std::vector<fp_t> coh(width / 2);
+	pcross->h1(h.data());
+	pcross->coherence(coh.data());
+
+	double fb = 0;
+	double fbinc = double(sample_rate) / width;
+	for (size_t i = 0; i < width / 2; ++i)
+	{
+		if (sample_rate != NoSampleRate)
+		{
+			std::cout << fb << " ";
+			fb += fbinc;
+		}
+		fp_t mag = std::abs(h[i]);
+		if (bDB)
+			mag = fp_t(20.0) * log10(mag);
+		std::cout << mag << " " << std::arg(h[i]) * fp_t(180.0 / std::numbers::pi) << " " << coh[i] << "\n";
+	}
+	return 0;
+}
+
+// high resolution spectrum of the band 'lo' to 'hi', decimated as far as the band allows.
+int ZoomBand(mem_map_file<fp_t> const& mmf, size_t fftWidth, window_t wt, size_t sample_rate, double lo, double hi, bool bDB, bool bOnce)
+{
+	// keep the band out of the outer tenth at each end, where the decimating filter rolls off.
+	size_t const decimation = std::max<size_t>(1, static_cast<size_t>(0.8 * sample_rate / (hi - lo)));
+	auto pzoom = make_zoom_fft(fftWidth, wt, double(sample_rate), (lo + hi) / 2, decimation);
+	size_t const width = pzoom->width();
+	size_t const span = pzoom->span();
+	size_t const hop = width * decimation / 2;
+	size_t const length = mmf.length();
+
+	std::cerr << "FFTit. Zoom " << lo << " to " << hi << " Hz,  width " << width << ", window " << wt_to_string(wt)
+		<< ", decimation " << decimation << ", resolution " << double(sample_rate) / (width * decimation) << " Hz\n";
+	if (length < span)
+	{
+		std::cerr << "Insufficient signal supplied for the specified FFT width and band\n";
+
+		return -1;
+	}
+	std::vector<fp_t> mean(width);
+	size_t nffts = 1;
+	if (bOnce)
+	{
+		auto [ob, oe] = (*pzoom) (mmf.ptr() + (length - span) / 2, mmf.ptr() + (length - span) / 2 + span);
+		std::copy(ob, oe, mean.begin());
+	}
+	else
+	{
+		nffts = (length - span) / hop + 1;
+		for (size_t n = 0; n < nffts; ++n)
+		{
+			auto [ob, oe] = (*pzoom) (mmf.ptr() + n * hop, mmf.ptr() + n * hop + span);
+			std::transform(mean.begin(), mean.end(), ob, mean.begin(), std::plus<>());
+		}
+	}
+	for (size_t i = 0; i < width; ++i)
+	{
+		double const f = pzoom->bin_frequency(i);
+		if (f < lo || f > hi)
+			continue;
+		fp_t out = mean[i] / fp_t(nffts);
+		if (bDB)
+			out = fp_t(20.0) * log10(out);
+		std::cout << f << " " << out << "\n";
+	}
+	return 0;
+}
+
+// constant-Q spectrum from 'lo' to 'hi' Hz, averaged over the file unless bOnce.
+int ConstantQ(mem_map_file<fp_t> const& mmf, window_t wt, size_t sample_rate, double lo, double hi, size_t bpo, bool bDB, bool bOnce)
+{
+	auto pcqt = make_cqt(double(sample_rate), lo, hi, bpo, wt);
+	if (!pcqt)
+	{
+		std::cerr << "Constant-Q range provided needs too wide an FFT, or was not understood\n";
+
+		return -1;
+	}
+	size_t const width = pcqt->width();
+	size_t const bins = pcqt->bins();
+	size_t const length = mmf.length();
+	std::cerr << "FFTit. Constant-Q,  width " << width << ", window " << wt_to_string(wt) << ", " << bins << " bins, "
+		<< pcqt->kernel_size() << " kernel coefficients\n";
+
+	size_t nffts = bOnce ? (length >= width ? 1 : 0) : frame_count(length, width);
+	if (nffts == 0)
+	{
+		std::cerr << "Insufficient signal supplied for the specified range\n";
+
+		return -1;
+	}
+	std::vector<fp_t> out(nffts * bins);
+	if (bOnce)
+		(*pcqt) (mmf.ptr() + (length - width) / 2, 1, 0, out.data());
+	else
+		(*pcqt) (mmf.ptr(), nffts, width / 2, out.data());
+	for (size_t k = 0; k < bins; ++k)
+	{
+		fp_t mean = 0;
+		for (size_t n = 0; n < nffts; ++n)
+			mean += out[n * bins + k];
+		mean /= fp_t(nffts);
+		if (bDB)
+			mean = fp_t(20.0) * log10(mean);
+		std::cout << pcqt->bin_frequency(k) << " " << mean << "\n";
+	}
+	return 0;
+}
+
+// multitaper spectrum, averaged over the file unless bOnce.
+int Multitaper(mem_map_file<fp_t> const& mmf, size_t fftWidth, double nw, size_t tapers, size_t sample_rate, bool bRange, double lo, double hi,
+				bool bDB, bool bOnce)
+{
+	auto pmt = make_multitaper(fftWidth, nw, tapers);
+	if (!pmt)
+	{
+		std::cerr << "Time-bandwidth or taper count provided was not understood, they need n at least 1 and k no more than 2n\n";
+
+		return -1;
+	}
+	size_t const width = pmt->width();
+	std::cerr << "FFTit. Multitaper,  width " << width << ", NW " << nw << ", " << pmt->tapers() << " tapers, the last concentrated "
+		<< pmt->concentration(pmt->tapers() - 1) << "\n";
+
+	auto const [binLo, binHi] = bin_range(width, sample_rate, bRange, lo, hi);
+	auto transform = [&](size_t n)
+	{
+		return (*pmt) (mmf.ptr() + n, mmf.ptr() + n + width);
+	};
+	std::vector<fp_t> mean(width / 2);
+	stats_clock::duration average_t{};
+	if (!Average(transform, mmf.length(), width, bOnce, mean, false, average_t))
+	{
+		std::cerr << "Insufficient signal supplied for the specified FFT width\n";
+
+		return -1;
+	}
+	WriteSpectrum(std::cout, mean, width, 1, binLo, binHi, sample_rate, bDB, window_t::NOWINDOW, 0, 0);
+	return 0;
+}
+
+// the plain spectrum settings, common to every input of a batch.
+struct spectrum_opts_t
+{
+	size_t   fftWidth;
+	window_t wt;
+	precision_t precision;
+	format_t format;
+	size_t   channels;
+	size_t   live;
+	bool     bRange;
+	double   rangeLo;
+	double   rangeHi;
+	size_t   sample_rate;
+	bool     bDB;
+	bool     bOnce;
+	size_t   nPeaks;
+	size_t   peakSep;
+};
+
+// measures the kernels for the width into 'wisdomFile', already holding anything it knew, so the processors made
+// after find it. Several channels' processor uses a single channel's wisdom, so that's what is measured for it.
+// Where there's nothing to measure the file is left as it was.
+void MeasureWisdom(char const* wisdomFile, size_t fftWidth, window_t wt, precision_t precision)
+{
+	// no wisdom yet is fine, it's made here.
+	load_wisdom(wisdomFile);
+	if (!can_measure(fftWidth, precision))
+	{
+		std::cerr << "Nothing to measure at width " << (size_t(1) << fftWidth) << " with this precision, <" << wisdomFile << "> not saved\n";
+		return;
+	}
+	make_fft(fftWidth, wt, plan_t::MEASURE, precision);
+	if (!save_wisdom(wisdomFile))
+		std::cerr << "Couldn't save wisdom to <" << wisdomFile << ">\n";
+}
+
+// the spectrum of each of 'inputs' to its own '<input>.txt', on 'threads' workers that each take the
+// next input as they finish one. A single channel's workers share one processor, each with its own workspace.
+// Otherwise every worker has its own processor, and so its own working buffers, but the processors share one
+// set of twiddle and window tables. Returns the number of inputs that failed.
+size_t Batch(std::vector<std::string> const& inputs, size_t threads, spectrum_opts_t const& o)
+{
+	std::atomic<size_t> next{ 0 };
+	std::atomic<size_t> failed{ 0 };
+	std::mutex report;
+	auto note = [&](std::string const& in, char const* what)
+	{
+		std::lock_guard<std::mutex> l(report);
+		std::cerr << "FFTit. <" << in << "> " << what << "\n";
+	};
+	// pruned before it's shared.
+	std::unique_ptr<IProcessorFFT> pfft;
+	if (o.channels == 1)
+	{
+		pfft = make_fft(o.fftWidth, o.wt, plan_t::ESTIMATE, o.precision);
+		if (o.live != 0 || o.bRange)
+		{
+			auto const [binLo, binHi] = bin_range(pfft->width(), o.sample_rate, o.bRange, o.rangeLo, o.rangeHi);
+			pfft->prune(binLo, binHi);
+		}
+	}
+	auto worker = [&]()
+	{
+		std::unique_ptr<IFFTWorkspace> ws;
+		std::unique_ptr<IProcessorFFTMulti> pmulti;
+		if (pfft)
+			ws = pfft->make_workspace();
+		else
+			pmulti = make_fft_multi(o.fftWidth, o.wt, o.channels);
+		size_t const width = pfft ? pfft->width() : pmulti->width();
+		size_t const frame = o.live ? o.live : width;
+		auto const [binLo, binHi] = bin_range(width, o.sample_rate, o.bRange, o.rangeLo, o.rangeHi);
+		std::vector<fp_t> mean(o.channels * width / 2);
+		stats_clock::duration average_t{};
+
+		for (size_t i = next++; i < inputs.size(); i = next++)
+		{
+			mem_map_file<fp_t> mmf(inputs[i].c_str());
+			if (!mmf)
+			{
+				note(inputs[i], "couldn't be opened");
+				++failed;
+				continue;
+			}
+			auto transform = [&](size_t n)
+			{
+				return Frame(pfft.get(), pmulti.get(), mmf, o.format, n * o.channels, frame * o.channels, ws.get());
+			};
+			std::fill(mean.begin(), mean.end(), fp_t(0));
+			if (!Average(transform, mmf.bytelength() / sample_bytes(o.format) / o.channels, frame, o.bOnce, mean, false, average_t))
+			{
+				note(inputs[i], "has insufficient signal for the specified FFT width");
+				++failed;
+				continue;
+			}
+			std::ofstream os(inputs[i] + ".txt");
+			WriteSpectrum(os, mean, width, o.channels, binLo, binHi, o.sample_rate, o.bDB, o.wt, o.nPeaks, o.peakSep);
+			os.close();
+			if (!os)
+			{
+				note(inputs[i], "couldn't write its output");
+				++failed;
+				continue;
+			}
+			note(inputs[i], "done");
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (size_t t = 1; t < threads; ++t)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& t : pool)
+		t.join();
+	return failed;
 }
 
 int main(int argc, char* argv[])
 {
+	auto const t_start = stats_clock::now();
+
 	Welcome();
 
 	if (argc < 2)
@@ -49,12 +588,33 @@ int main(int argc, char* argv[])
 
 		return -1;
 	}
-	int		nInFileArg = 0;
+	std::vector<std::string> inputs;
+	bool    bList = false;
+	// the last argument, if it followed an input, and so may be the sample rate.
+	char const* rateArg = nullptr;
+	size_t  threads = std::max<size_t>(1, std::thread::hardware_concurrency());
 	size_t  fftWidth = 18;
 	bool    bDB = false;
 	bool    bOnce = false;
-	size_t sample_rate = -1;
+	bool    bStats = false;
+	bool    bCross = false;
+	double  bandLo = 0;
+	double  bandHi = 0;
+	size_t  live = 0;
+	size_t  cqBins = 0;
+	double  mtNW = 0;
+	size_t  mtTapers = 0;
+	size_t  nPeaks = 0;
+	size_t  peakSep = 3;
+	bool    bRange = false;
+	double  rangeLo = 0;
+	double  rangeHi = 0;
+	size_t sample_rate = NoSampleRate;
+	size_t channels = 1;
 	window_t wt = window_t::HAMMING;
+	precision_t precision = precision_t::SINGLE;
+	format_t format = format_t::FP;
+	char const* wisdomFile = nullptr;
 
 	int		arg = 1;
 	while (arg < argc)
@@ -78,6 +638,111 @@ int main(int argc, char* argv[])
 			case 'w':
 				wt = wt_from_code(argv[arg][2]);
 				break;
+			case 'I':
+			case 'i':
+				switch (atoi(argv[arg] + 2))
+				{
+				case 16:
+					format = format_t::S16;
+					break;
+				case 24:
+					format = format_t::S24;
+					break;
+				case 32:
+					format = format_t::S32;
+					break;
+				default:
+					std::cerr << "Sample format provided was not understood\n";
+					Usage();
+					return -1;
+				}
+				break;
+			case 'E':
+			case 'e':
+				switch (argv[arg][2])
+				{
+				case 'F':
+				case 'f':
+					precision = precision_t::SINGLE;
+					break;
+				case 'D':
+				case 'd':
+					precision = precision_t::DOUBLE;
+					break;
+				case 'M':
+				case 'm':
+					precision = precision_t::MIXED;
+					break;
+				case 'X':
+				case 'x':
+					precision = precision_t::FIXED;
+					break;
+				default:
+					std::cerr << "Precision provided was not understood\n";
+					Usage();
+					return -1;
+				}
+				break;
+			case 'M':
+			case 'm':
+				wisdomFile = argv[arg] + 2;
+				break;
+			case 'S':
+			case 's':
+				bStats = true;
+				break;
+			case 'C':
+			case 'c':
+				channels = atoi(argv[arg] + 2);
+				break;
+			case 'X':
+			case 'x':
+				bCross = true;
+				break;
+			case 'L':
+			case 'l':
+				live = atoi(argv[arg] + 2);
+				break;
+			case 'R':
+			case 'r':
+				bRange = true;
+				rangeLo = atof(argv[arg] + 2);
+				if (char const* c = strchr(argv[arg] + 2, ':'))
+					rangeHi = atof(c + 1);
+				break;
+			case 'P':
+			case 'p':
+				nPeaks = argv[arg][2] ? atoi(argv[arg] + 2) : 8;
+				if (char const* c = strchr(argv[arg] + 2, ':'))
+					peakSep = atoi(c + 1);
+				break;
+			case 'N':
+			case 'n':
+				// -N and -N:k take the default time-bandwidth.
+				mtNW = argv[arg][2] != '\0' && argv[arg][2] != ':' ? atof(argv[arg] + 2) : 4.0;
+				if (!(mtNW > 0))
+				{
+					std::cerr << "Multitaper time-bandwidth provided was not understood, it needs to be more than 0\n";
+					Usage();
+					return -1;
+				}
+				if (char const* c = strchr(argv[arg] + 2, ':'))
+					mtTapers = atoi(c + 1);
+				break;
+			case 'Q':
+			case 'q':
+				cqBins = atoi(argv[arg] + 2);
+				break;
+			case 'T':
+			case 't':
+				threads = atoi(argv[arg] + 2);
+				break;
+			case 'B':
+			case 'b':
+				bandLo = atof(argv[arg] + 2);
+				if (char const* c = strchr(argv[arg] + 2, ':'))
+					bandHi = atof(c + 1);
+				break;
 			default:
 				std::cerr << "Unknown argument \'" << argv[arg][1] << "\'!\n";
 				Usage();
@@ -85,19 +750,44 @@ int main(int argc, char* argv[])
 			}
 		}
 		else
+		if (argv[arg][0] == '@')
 		{
-			if (nInFileArg == 0)
-			{
-				nInFileArg = arg;
-			}
-			else
+			std::ifstream list(argv[arg] + 1);
+			if (!list)
 			{
-				sample_rate = ::atoi(argv[arg]);
+				std::cerr << "Couldn't open list <" << argv[arg] + 1 << ">\n";
+
+				return -1;
 			}
+			for (std::string in; std::getline(list, in); )
+				if (!in.empty())
+					inputs.push_back(in);
+			bList = true;
+			rateArg = nullptr;
+		}
+		else
+		{
+			rateArg = inputs.empty() ? nullptr : argv[arg];
+			inputs.push_back(argv[arg]);
 		}
 		++arg;
 	}
+	// the last argument after the inputs is the sample rate if it starts with a digit, and then it has
+	// to be a whole number of Hz, so 44.1k is refused rather than taken for another input.
+	if (rateArg && std::isdigit(static_cast<unsigned char>(rateArg[0])))
+	{
+		inputs.pop_back();
+		char* end = nullptr;
+		double const rate = strtod(rateArg, &end);
+		sample_rate = *end == '\0' && rate >= 1 && rate == std::floor(rate) ? static_cast<size_t>(rate) : 0;
+	}
 	// checks
+	if (inputs.empty())
+	{
+		std::cerr << "No input file provided\n";
+		Usage();
+		return -1;
+	}
 	if (sample_rate == 0)
 	{
 		std::cerr << "Sample rate provided was not understood\n";
@@ -110,89 +800,172 @@ int main(int argc, char* argv[])
 		Usage();
 		return -1;
 	}
-	mem_map_file<fp_t> mmf(argv[nInFileArg]);
-	if (!mmf)
+	if (channels == 0)
 	{
-		std::cerr << "Couldn't open <" << argv[nInFileArg] << ">\n";
-
+		std::cerr << "Channel count provided was not understood\n";
+		Usage();
 		return -1;
 	}
-
-	// an FFT implementation!
-	auto pfft = make_fft(fftWidth, wt);
-	std::vector<fp_t> mean(pfft->width());
-
-	// report
-	std::cerr << "FFTit. Processing,  width " << pfft->width() << ", window " << wt_to_string(wt) << "\n";
-
-	if (bOnce)
+	if (format != format_t::FP && (bCross || bandHi != 0 || cqBins != 0))
 	{
-		if (mmf.length() < pfft->width())
-		{
-			std::cerr << "Insufficient signal supplied for the specified FFT width\n";
-
-			return -1;
-		}
-		size_t offset = (mmf.length() - pfft->width()) / 2;
-		// just a single effort
-		auto[ob, oe] = (*pfft) (mmf.ptr() + offset, mmf.ptr() + offset + pfft->width());
-		std::copy(ob, oe, mean.begin());
+		std::cerr << "-X, -B and -Q need float input\n";
+		Usage();
+		return -1;
 	}
-	else
+	if (precision != precision_t::SINGLE && (channels != 1 || bCross || bandHi != 0 || cqBins != 0))
 	{
-		// 50% overlap
-		size_t nffts = mmf.length();
-		if (nffts >= pfft->width() * 3 / 2)
+		std::cerr << "-Ed, -Em and -Ex are for a single channel, and not with -X, -B or -Q\n";
+		Usage();
+		return -1;
+	}
+	bool const bMulti = mtNW != 0;
+	if (bMulti && (format != format_t::FP || precision != precision_t::SINGLE || channels != 1 || bCross || bandHi != 0 || cqBins != 0 || live != 0 || nPeaks != 0))
+	{
+		std::cerr << "-N takes one channel of float input, and not -E, -X, -B, -Q, -L or -P\n";
+		Usage();
+		return -1;
+	}
+	bool const bBatch = bList || inputs.size() > 1;
+	if (bBatch && (bMulti || bCross || bandHi != 0 || cqBins != 0 || bStats || threads == 0))
+	{
+		std::cerr << "A batch writes plain spectra on at least one thread, -X, -B, -Q, -N and -S take a single input\n";
+		Usage();
+		return -1;
+	}
+	if (cqBins != 0)
+	{
+		if (sample_rate == NoSampleRate)
 		{
-			nffts /= (pfft->width() / 2);
-			nffts -= 1;
+			std::cerr << "Constant-Q needs the sample rate\n";
+			Usage();
+			return -1;
 		}
-		else
-		if (nffts > pfft->width())
-			nffts = 1;
-		else
+		mem_map_file<fp_t> mmf(inputs[0].c_str());
+		if (!mmf)
 		{
-			std::cerr << "Insufficient signal supplied for the specified FFT width\n";
+			std::cerr << "Couldn't open <" << inputs[0] << ">\n";
 
 			return -1;
 		}
-
-		for (size_t n = 0; n < nffts; ++n)
+		return ConstantQ(mmf, wt, sample_rate, bRange ? rangeLo : 27.5, bRange ? rangeHi : sample_rate / 2.0, cqBins, bDB, bOnce);
+	}
+	bool const bPrune = live != 0 || bRange;
+	if (bPrune && (channels != 1 || bCross || live > (size_t(1) << fftWidth) || rangeLo < 0 || (bRange && rangeHi < rangeLo)))
+	{
+		std::cerr << "Frame length or range provided was not understood, they need a single channel, n no more than the FFT width and lo:hi\n";
+		Usage();
+		return -1;
+	}
+	if (bMulti)
+	{
+		mem_map_file<fp_t> mmf(inputs[0].c_str());
+		if (!mmf)
 		{
-			auto[ob, oe] = (*pfft) (mmf.ptr() + n * pfft->width() / 2, mmf.ptr() + n * pfft->width() / 2 + pfft->width());
-			// add to average
-			std::transform(mean.begin(), mean.end(), ob, mean.begin(), std::plus<>());
+			std::cerr << "Couldn't open <" << inputs[0] << ">\n";
+
+			return -1;
 		}
-		using namespace std::placeholders;
-		std::transform(mean.begin(), mean.end(), mean.begin(), std::bind(std::divides<fp_t>(), _1, fp_t(nffts)));
+		return Multitaper(mmf, fftWidth, mtNW, mtTapers, sample_rate, bRange, rangeLo, rangeHi, bDB, bOnce);
 	}
-	if (sample_rate != -1)
+	bool const bZoom = bandHi != 0;
+	if (bZoom && (sample_rate == NoSampleRate || bandLo < 0 || bandHi <= bandLo || bandHi > sample_rate / 2.0))
 	{
-		double fb = 0;
-		double fbinc = double(sample_rate) / pfft->width();
-		for (size_t i = 0; i < pfft->width() / 2; ++i)
+		std::cerr << "Band provided was not understood, it needs lo:hi within 0 and half the sample rate, and the sample rate\n";
+		Usage();
+		return -1;
+	}
+	if (bBatch)
+	{
+		// measured here once, every worker's processor then finds it.
+		if (wisdomFile)
+			MeasureWisdom(wisdomFile, fftWidth, wt, precision);
+		threads = std::min(threads, inputs.size());
+		std::cerr << "FFTit. Batch of " << inputs.size() << ",  width " << (size_t(1) << fftWidth) << ", window " << wt_to_string(wt)
+			<< ", " << threads << " threads\n";
+		size_t const failed = Batch(inputs, threads, { fftWidth, wt, precision, format, channels, live, bRange, rangeLo, rangeHi, sample_rate, bDB, bOnce, nPeaks, peakSep });
+		if (failed != 0)
 		{
-			fp_t out;
-			if (bDB)
-				out = fp_t(20.0) * log10(mean[i]);
-			else
-				out = mean[i];
+			std::cerr << failed << " of " << inputs.size() << " inputs failed\n";
 
-			std::cout << fb << " " << out << "\n";
-			fb += fbinc;
+			return -1;
 		}
+		return 0;
+	}
+	mem_map_file<fp_t> mmf(inputs[0].c_str());
+	if (!mmf)
+	{
+		std::cerr << "Couldn't open <" << inputs[0] << ">\n";
+
+		return -1;
 	}
+	auto const t_mapped = stats_clock::now();
+	if (bCross)
+		return CrossSpectrum(mmf, fftWidth, wt, sample_rate, bDB, bOnce);
+	if (bZoom)
+		return ZoomBand(mmf, fftWidth, wt, sample_rate, bandLo, bandHi, bDB, bOnce);
+
+	// an FFT implementation! one for a single channel, or one that takes them interleaved.
+	std::unique_ptr<IProcessorFFT> pfft;
+	std::unique_ptr<IProcessorFFTMulti> pmulti;
+	if (wisdomFile)
+		MeasureWisdom(wisdomFile, fftWidth, wt, precision);
+	if (channels == 1)
+		pfft = make_fft(fftWidth, wt, plan_t::ESTIMATE, precision);
+	if (channels > 1)
+		pmulti = make_fft_multi(fftWidth, wt, channels);
+
+	size_t const width = pfft ? pfft->width() : pmulti->width();
+	// samples of each channel per frame, fewer than 'width' are zero padded.
+	size_t const frame = live ? live : width;
+	// the bins to write.
+	auto const [binLo, binHi] = bin_range(width, sample_rate, bRange, rangeLo, rangeHi);
+	if (bPrune)
+		pfft->prune(binLo, binHi);
+	// in samples of each channel.
+	size_t const length = mmf.bytelength() / sample_bytes(format) / channels;
+	// 'frame' samples of each channel from sample 'n', the magnitudes for each channel in turn.
+	auto transform = [&](size_t n)
+	{
+		return Frame(pfft.get(), pmulti.get(), mmf, format, n * channels, frame * channels);
+	};
+
+	std::vector<fp_t> mean(channels * width / 2);
+	if (pfft)
+		pfft->enable_stats(bStats);
 	else
+		pmulti->enable_stats(bStats);
+	auto const t_made = stats_clock::now();
+	auto const faults_b = page_faults();
+	stats_clock::duration average_t{};
+
+	// report
+	std::cerr << "FFTit. Processing,  width " << width << ", window " << wt_to_string(wt);
+	if (channels > 1)
+		std::cerr << ", " << channels << " channels";
+	if (format != format_t::FP)
+		std::cerr << ", " << sample_bytes(format) * 8 << " bit PCM";
+	if (frame != width)
+		std::cerr << ", frame " << frame;
+	if (binLo != 0 || binHi != width / 2)
+		std::cerr << ", bins " << binLo << " to " << binHi;
+	std::cerr << "\n";
+
+	if (!Average(transform, length, frame, bOnce, mean, bStats, average_t))
 	{
-		for (size_t i = 0; i < pfft->width() / 2; ++i)
-		{
-			fp_t out;
-			if (bDB)
-				out = fp_t(20.0) * log10(mean[i]);
-			else
-				out = mean[i];
-			std::cout << out << "\n";
-		}
+		std::cerr << "Insufficient signal supplied for the specified FFT width\n";
+
+		return -1;
+	}
+	auto const faults_e = page_faults();
+	auto const t_processed = stats_clock::now();
+
+	WriteSpectrum(std::cout, mean, width, channels, binLo, binHi, sample_rate, bDB, wt, nPeaks, peakSep);
+	if (bStats)
+	{
+		std::cout.flush();
+		auto const t_done = stats_clock::now();
+		ReportStats(pfft ? pfft->stats() : pmulti->stats(), sample_bytes(format), t_mapped - t_start, t_made - t_mapped, average_t, t_done - t_processed, t_done - t_start,
+			{ faults_e.first - faults_b.first, faults_e.second - faults_b.second });
 	}
 
 	return 0;
@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#if defined (_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "fftlib.h"
+
+void Welcome()
+{
+	std::cerr << "FFTlive 1.00 Copyright Paul Ranson (c) 2009-2022\n";
+	std::cerr << "email - paul@epicyclism.com\n\n";
+	std::cerr << "Analyses raw sample data as it arrives\n";
+	std::cerr << "(sizeof fp type is " << sizeof(fp_t) << ")\n\n";
+}
+
+void Usage()
+{
+	std::cerr << "Usage : FFTlive [-Fn] [-Wn] [-Tn] [-Qn] [-In] [-A] [sample rate]\n";
+	std::cerr << "Reads packed floats from stdin, or a descriptor, and writes a line to stdout for each\n";
+	std::cerr << "spectrum as it is ready, the frame number, and the frequency and magnitude of the\n";
+	std::cerr << "strongest bin, or with -A every bin.\n";
+	std::cerr << "Options. -Fn, use an FFT width of 2^n, default 14.\n";
+	std::cerr << "         -Wn, select a window function, as fftit. Default Hamming.\n";
+	std::cerr << "         -Tn, n transform threads, default 1.\n";
+	std::cerr << "         -Qn, n frames queued for each thread, default 8.\n";
+	std::cerr << "         -In, read from file descriptor n, default 0, stdin.\n";
+	std::cerr << "         -A,  write the whole spectrum of each frame.\n";
+	std::cerr << "Without the sample rate the frequencies are bin numbers. Counts and latency go to stderr at the end.\n\n";
+}
+
+// read whatever is there, up to 'bytes'. 0 at the end, negative on error.
+long read_some(int fd, void* buf, size_t bytes)
+{
+#if defined (_WIN32)
+	return ::_read(fd, buf, static_cast<unsigned>(bytes));
+#else
+	return static_cast<long>(::read(fd, buf, bytes));
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	Welcome();
+
+	size_t   fftWidth = 14;
+	size_t   workers = 1;
+	size_t   depth = 8;
+	int      fd = 0;
+	bool     bAll = false;
+	size_t   sample_rate = 0;
+	window_t wt = window_t::HAMMING;
+
+	int		arg = 1;
+	while (arg < argc)
+	{
+		if (argv[arg][0] == '-' || argv[arg][0] == '/')
+		{
+			switch (argv[arg][1])
+			{
+			case 'F':
+			case 'f':
+				fftWidth = atoi(argv[arg] + 2);
+				break;
+			case 'W':
+			case 'w':
+				wt = wt_from_code(argv[arg][2]);
+				break;
+			case 'T':
+			case 't':
+				workers = atoi(argv[arg] + 2);
+				break;
+			case 'Q':
+			case 'q':
+				depth = atoi(argv[arg] + 2);
+				break;
+			case 'I':
+			case 'i':
+				fd = atoi(argv[arg] + 2);
+				break;
+			case 'A':
+			case 'a':
+				bAll = true;
+				break;
+			default:
+				std::cerr << "Unknown argument \'" << argv[arg][1] << "\'!\n";
+				Usage();
+				return -1;
+			}
+		}
+		else
+			sample_rate = ::atoi(argv[arg]);
+		++arg;
+	}
+	auto pipe = make_fft_pipeline(fftWidth, wt, workers, depth);
+	if (!pipe)
+	{
+		std::cerr << "FFTWidth, threads or queue provided is out of range, widths valid between " << FFTWdMin << " and " << FFTWdMax << " inclusive.\n";
+		Usage();
+		return -1;
+	}
+#if defined (_WIN32)
+	::_setmode(fd, _O_BINARY);
+#endif
+	size_t const width = pipe->width();
+	double const fbinc = sample_rate ? double(sample_rate) / width : 1.0;
+	std::cerr << "FFTlive. Processing,  width " << width << ", window " << wt_to_string(wt) << ", " << workers << " threads\n";
+
+	// the consumer, writing as spectra arrive.
+	std::atomic<bool> done{ false };
+	std::thread consumer([&]()
+		{
+			uint64_t frame = 0;
+			for (;;)
+			{
+				fp_t const* s = pipe->front();
+				if (!s)
+				{
+					// everything pushed has been transformed and taken.
+					if (done.load() && pipe->drained())
+						break;
+					std::this_thread::yield();
+					continue;
+				}
+				std::cout << frame;
+				if (bAll)
+				{
+					for (size_t i = 0; i < width / 2; ++i)
+						std::cout << " " << s[i];
+				}
+				else
+				{
+					size_t const pk = std::max_element(s, s + width / 2) - s;
+					std::cout << " " << pk * fbinc << " " << s[pk];
+				}
+				std::cout << "\n";
+				pipe->release();
+				++frame;
+			}
+		});
+
+	// the producer, straight from the descriptor. Reads return what has arrived,
+	// so a sample may be split across reads.
+	std::vector<fp_t> buf(std::max<size_t>(width / 8, 256));
+	size_t have = 0;
+	for (;;)
+	{
+		long const n = read_some(fd, reinterpret_cast<char*>(buf.data()) + have, buf.size() * sizeof(fp_t) - have);
+		if (n <= 0)
+			break;
+		have += n;
+		size_t const samples = have / sizeof(fp_t);
+		pipe->push(buf.data(), buf.data() + samples);
+		have -= samples * sizeof(fp_t);
+		std::memmove(buf.data(), reinterpret_cast<char*>(buf.data()) + samples * sizeof(fp_t), have);
+	}
+	done.store(true);
+	consumer.join();
+
+	auto const st = pipe->stats();
+	std::cerr << "FFTlive. " << st.frames << " frames, " << st.overruns << " overruns, worst latency "
+		<< st.max_latency_ns / 1e6 << " ms\n";
+
+	return 0;
+}
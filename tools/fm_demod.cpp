@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <vector>
+#include <numeric>
+#include <numbers>
+#include <cmath>
+
+#include "fftlib.h"
+#include "mm_file.h"
+#include "mm_out_file.h"
+
+using stats_clock = std::chrono::steady_clock;
+
+void Usage()
+{
+	std::cerr << "Demodulates a raw PCM file of 'fm', such as Fm_generate makes\n";
+	std::cerr << "Usage - Fm_demod [-Fn] [-Ofile] [-Afile] <inputfile> <sample rate>\n";
+	std::cerr << "Writes the carrier, deviation and modulation frequency found to stdout, the modulation\n";
+	std::cerr << "up to a few hundred Hz, from the frequency averaged over each millisecond.\n";
+	std::cerr << "Options. -Fn, Hilbert transform block of 2^n, default 14. Wider is flatter nearer 0Hz.\n";
+	std::cerr << "         -Ofile, write the instantaneous frequency in Hz of each sample to 'file'.\n";
+	std::cerr << "         -Afile, write the instantaneous amplitude of each sample to 'file'.\n";
+	std::cerr << "Output files are packed arrays of F, the same length as the input.\n\n";
+	std::cerr << "(sizeof fp_t is " << sizeof(fp_t) << ")\n\n";
+}
+
+int main(int argc, char* argv[])
+{
+	size_t fftWidth = 14;
+	char const* freqFile = nullptr;
+	char const* ampFile = nullptr;
+	char const* inFile = nullptr;
+	size_t sample_rate = 0;
+
+	int		arg = 1;
+	while (arg < argc)
+	{
+		if (argv[arg][0] == '-' || argv[arg][0] == '/')
+		{
+			switch (argv[arg][1])
+			{
+			case 'F':
+			case 'f':
+				fftWidth = atoi(argv[arg] + 2);
+				break;
+			case 'O':
+			case 'o':
+				freqFile = argv[arg] + 2;
+				break;
+			case 'A':
+			case 'a':
+				ampFile = argv[arg] + 2;
+				break;
+			default:
+				std::cerr << "Unknown argument \'" << argv[arg][1] << "\'!\n";
+				Usage();
+				return 1;
+			}
+		}
+		else
+		if (!inFile)
+			inFile = argv[arg];
+		else
+			sample_rate = ::atoi(argv[arg]);
+		++arg;
+	}
+	if (!inFile || sample_rate == 0 || fftWidth < FFTWdMin || fftWidth > FFTWdMax)
+	{
+		Usage();
+		return 1;
+	}
+	mem_map_file<fp_t> in(inFile);
+	if (!in)
+	{
+		std::cerr << "Couldn't open <" << inFile << ">\n";
+		return -1;
+	}
+	size_t const length = in.length();
+	mem_map_out_file<fp_t> fo;
+	mem_map_out_file<fp_t> ao;
+	if ((freqFile && !fo.open(freqFile, length, true)) || (ampFile && !ao.open(ampFile, length, true)))
+	{
+		std::cerr << "Couldn't open output file <" << (freqFile && !fo ? freqFile : ampFile) << ">\n";
+		return -1;
+	}
+
+	auto const t_start = stats_clock::now();
+	auto pas = make_analytic_signal(fftWidth);
+	size_t const block = pas->block();
+	size_t const delay = pas->delay();
+	std::vector<fp_t> tin(block);
+	std::vector<std::complex<fp_t>> z(block);
+	std::vector<fp_t> amp(block);
+	std::vector<fp_t> freq(block);
+
+	// the edges, where the filter sees the signal start and stop, are left out of the statistics.
+	size_t const edge = 2 * delay;
+	double sumA = 0;
+	// the instantaneous frequency in Hz of each sample counted.
+	std::vector<fp_t> track;
+	track.reserve(length);
+
+	// input n comes out as output n + delay, the end flushed with zeros.
+	for (size_t n0 = 0; n0 < length + delay; n0 += block)
+	{
+		fp_t const* p = in.ptr() + n0;
+		if (n0 + block > length)
+		{
+			std::fill(tin.begin(), tin.end(), fp_t(0));
+			if (n0 < length)
+				std::copy(p, in.ptr() + length, tin.begin());
+			p = tin.data();
+		}
+		(*pas) (p, z.data(), amp.data(), freq.data());
+		for (size_t n = 0; n < block; ++n)
+		{
+			if (n0 + n < delay || n0 + n - delay >= length)
+				continue;
+			size_t const s = n0 + n - delay;
+			if (freqFile)
+				fo.ptr()[s] = freq[n] * fp_t(sample_rate);
+			if (ampFile)
+				ao.ptr()[s] = amp[n];
+			if (s >= edge && s + edge < length)
+			{
+				sumA += amp[n];
+				track.push_back(freq[n] * fp_t(sample_rate));
+			}
+		}
+	}
+	auto const t_done = stats_clock::now();
+	if (track.empty())
+	{
+		std::cerr << "Insufficient signal supplied for the block size\n";
+		return -1;
+	}
+	size_t const counted = track.size();
+
+	// a millisecond's moving average, so the crossings and extrema follow the modulation rather than the
+	// sample to sample noise of the estimate. Its gain at the modulation frequency is divided out below.
+	size_t const span = std::clamp<size_t>(sample_rate / 1000, 1, counted);
+	std::vector<double> smooth(counted - span + 1);
+	double run = std::accumulate(track.begin(), track.begin() + span, 0.0);
+	for (size_t t = 0; t < smooth.size(); ++t)
+	{
+		smooth[t] = run / span;
+		if (t + span < counted)
+			run += track[t + span] - track[t];
+	}
+	double carrier = std::accumulate(smooth.begin(), smooth.end(), 0.0) / smooth.size();
+
+	// the upward crossings of the carrier, each the start of a modulation cycle. The hysteresis is a tenth
+	// of the deviation a sine of the same power would have, and at least 10ppm of the carrier, so an
+	// unmodulated carrier's noise isn't taken for modulation.
+	double power = 0;
+	for (double f : smooth)
+		power += (f - carrier) * (f - carrier);
+	double const hysteresis = std::max(0.1 * std::sqrt(2.0 * power / smooth.size()), 1e-5 * carrier);
+	std::vector<size_t> ups;
+	bool below = false;
+	for (size_t t = 0; t < smooth.size(); ++t)
+	{
+		double const d = smooth[t] - carrier;
+		if (d < -hysteresis)
+			below = true;
+		else
+		if (below && d > hysteresis)
+		{
+			below = false;
+			ups.push_back(t);
+		}
+	}
+
+	double deviation;
+	double modulation = 0;
+	if (ups.size() > 1)
+	{
+		// whole cycles only, so a part cycle at either end doesn't move the carrier.
+		size_t const cycles = ups.back() - ups.front();
+		modulation = double(ups.size() - 1) * sample_rate / double(cycles);
+		carrier = std::accumulate(smooth.begin() + ups.front(), smooth.begin() + ups.back(), 0.0) / double(cycles);
+		// each cycle's swing, the median so the odd glitch in the estimate doesn't count.
+		std::vector<double> swings;
+		for (size_t c = 1; c < ups.size(); ++c)
+		{
+			auto const [lo, hi] = std::minmax_element(smooth.begin() + ups[c - 1], smooth.begin() + ups[c]);
+			swings.push_back((*hi - *lo) / 2.0);
+		}
+		std::nth_element(swings.begin(), swings.begin() + swings.size() / 2, swings.end());
+		deviation = swings[swings.size() / 2];
+		// the moving average's gain is sin(x) / x, only undone while it's well away from its first null.
+		double const x = std::numbers::pi * modulation * span / sample_rate;
+		if (x < std::numbers::pi / 2)
+			deviation *= x / std::sin(x);
+	}
+	else
+	{
+		auto const [lo, hi] = std::minmax_element(smooth.begin(), smooth.end());
+		deviation = (*hi - *lo) / 2.0;
+	}
+
+	double const secs = std::chrono::duration<double>(t_done - t_start).count();
+	std::cerr << "Fm_demod. " << length << " samples, block " << block << ", " << secs << " s, "
+		<< (secs > 0 ? length / secs / 1e6 : 0.0) << " MSamples/s\n";
+	std::cout << "carrier " << carrier << " Hz\n";
+	std::cout << "deviation " << deviation << " Hz, " << deviation / carrier << " of the carrier\n";
+	if (modulation > 0)
+		std::cout << "modulation " << modulation << " Hz\n";
+	else
+		std::cout << "modulation none found\n";
+	std::cout << "amplitude " << sumA / counted << "\n";
+
+	return 0;
+}
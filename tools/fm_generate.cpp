@@ -5,10 +5,9 @@
 //
 
 #include <iostream>
-#include <vector>
 #include <cstdlib>
 
-#include "basic_file.h"
+#include "mm_out_file.h"
 #include "fftlib.h"
 
 void Usage()
@@ -48,31 +47,25 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
-	// open output file
-	out_file_t of(argv[6]);
+	// open output file, sized up front so the signal is generated straight into it.
+	mem_map_out_file<fp_t> of(argv[6], sample_rate * duration, true);
 	if (!of)
 	{
 		std::cerr << "Couldn't open output file <" << argv[6] << ">\n";
 		return -1;
 	}
-
-	// allocate
-	std::vector<fp_t> buf;
-	buf.resize(sample_rate * duration);
+	of.advise(mm_advice_t::SEQUENTIAL);
 
 	// generate
 	if (modulation == fp_t(0) || deviation == fp_t(0))
 	{
-		fill_buffer_with_sine(carrier, buf.data(), buf.data() + buf.size(), sample_rate);
+		fill_buffer_with_sine(carrier, of.begin(), of.end(), sample_rate);
 	}
 	else
 	{
-		fill_buffer_with_FM(carrier, modulation, deviation, buf.data(), buf.data() + buf.size(), sample_rate);
+		fill_buffer_with_FM(carrier, modulation, deviation, of.begin(), of.end(), sample_rate);
 	}
 
-	// write
-	of.write(buf.data(), buf.size() * sizeof(fp_t));
-
 	return 0;
 }
 
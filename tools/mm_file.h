@@ -228,7 +228,7 @@ public:
 	mem_map_file() : sz_(0), pv_((void const*)-1)
 	{
 	}
-	mem_map_file(const char* sName)
+	mem_map_file(const char* sName) : mem_map_file()
 	{
 		open(sName);
 	}
@@ -0,0 +1,314 @@
+//
+// mm_out_file.h
+//
+// Windows/Linux minimal memory mapped writable file wrapper.
+// Creates (or truncates) a file of a given size and maps it shared, so
+// data can be produced directly into the file without an intermediate buffer.
+//
+// Copyright (c) 2008-2022 Paul Ranson, paul@epicyclism.com
+//
+// Refer to licence in repository.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+// hints for the expected access pattern of a mapped range.
+enum class mm_advice_t { NORMAL, SEQUENTIAL, RANDOM, WILLNEED, DONTNEED };
+
+#if defined (_WIN32)
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+template <typename T> class mem_map_out_file
+{
+private :
+	HANDLE hF_ ;
+	HANDLE hFM_ ;
+	void*  pV_ ;
+	size_t sz_ ;
+
+public :
+	mem_map_out_file() : hF_ { INVALID_HANDLE_VALUE }, hFM_ { nullptr }, pV_ { nullptr }, sz_ { 0 }
+	{
+	}
+	// length is in T, not bytes.
+	mem_map_out_file( LPCSTR sName, size_t length, bool preallocate = false ) : mem_map_out_file()
+	{
+		open ( sName, length, preallocate ) ;
+	}
+	mem_map_out_file( const mem_map_out_file& ) = delete ;
+	mem_map_out_file& operator= ( const mem_map_out_file& ) = delete ;
+	~mem_map_out_file()
+	{
+		close () ;
+	}
+	// creating the mapping with an explicit size extends the file, so 'preallocate' has nothing extra to do here.
+	bool open ( LPCSTR sName, size_t length, bool preallocate = false )
+	{
+		close () ;
+		hF_ = ::CreateFileA ( sName,
+							GENERIC_READ | GENERIC_WRITE,
+							0,
+							NULL,
+							CREATE_ALWAYS,
+							FILE_ATTRIBUTE_NORMAL,
+							NULL ) ;
+		if ( hF_ == INVALID_HANDLE_VALUE )
+		{
+			return false ;
+		}
+		sz_ = length * sizeof ( T ) ;
+		if ( sz_ == 0 )
+		{
+			return true ;
+		}
+		LARGE_INTEGER nL ;
+		nL.QuadPart = static_cast<LONGLONG>( sz_ ) ;
+		hFM_ = ::CreateFileMapping ( hF_,
+									0,
+									PAGE_READWRITE,
+									nL.HighPart,
+									nL.LowPart,
+									0 ) ;
+		if ( !hFM_ )
+		{
+			close () ;
+			return false ;
+		}
+		pV_ = ::MapViewOfFile ( hFM_,
+								FILE_MAP_WRITE,
+								0,
+								0,
+								sz_ ) ;
+		if ( !pV_ )
+		{
+			close () ;
+			return false ;
+		}
+		return true ;
+	}
+	// flush dirty pages to the file. if wait is false only schedules the write.
+	bool sync ( bool wait = true ) const
+	{
+		if ( !pV_ )
+		{
+			return true ;
+		}
+		if ( !::FlushViewOfFile ( pV_, 0 ))
+		{
+			return false ;
+		}
+		return wait ? !!::FlushFileBuffers ( hF_ ) : true ;
+	}
+	// no equivalent that is worth the trouble, accept and ignore.
+	bool advise ( mm_advice_t , size_t = 0, size_t = size_t ( -1 )) const
+	{
+		return true ;
+	}
+	size_t bytelength () const
+	{
+		return sz_ ;
+	}
+	size_t length () const
+	{
+		return sz_ / sizeof ( T ) ;
+	}
+	T* ptr () const
+	{
+		return reinterpret_cast<T*>( pV_ ) ;
+	}
+	operator T* () const
+	{
+		return reinterpret_cast<T*>( pV_ ) ;
+	}
+	T* begin () const
+	{
+		return reinterpret_cast<T*>( pV_ ) ;
+	}
+	T* end () const
+	{
+		return reinterpret_cast<T*>( pV_ ) + length () ;
+	}
+	void close ()
+	{
+		if ( pV_ )
+		{
+			::UnmapViewOfFile ( pV_ ) ;
+			pV_ = nullptr ;
+		}
+		if ( hFM_ )
+		{
+			::CloseHandle ( hFM_ ) ;
+			hFM_ = nullptr ;
+		}
+		if ( hF_ != INVALID_HANDLE_VALUE )
+		{
+			::CloseHandle ( hF_ ) ;
+			hF_ = INVALID_HANDLE_VALUE ;
+		}
+		sz_ = 0 ;
+	}
+	operator bool () const
+	{
+		return hF_ != INVALID_HANDLE_VALUE ;
+	}
+} ;
+#else
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+template < typename T > class mem_map_out_file
+{
+private:
+	int    fd_;
+	off_t  sz_;
+	void*  pv_;
+
+	static int to_madvise(mm_advice_t a)
+	{
+		switch (a)
+		{
+		default:
+		case mm_advice_t::NORMAL:
+			return MADV_NORMAL;
+		case mm_advice_t::SEQUENTIAL:
+			return MADV_SEQUENTIAL;
+		case mm_advice_t::RANDOM:
+			return MADV_RANDOM;
+		case mm_advice_t::WILLNEED:
+			return MADV_WILLNEED;
+		case mm_advice_t::DONTNEED:
+			return MADV_DONTNEED;
+		}
+	}
+
+public:
+	mem_map_out_file() : fd_(-1), sz_(0), pv_(MAP_FAILED)
+	{
+	}
+	// length is in T, not bytes.
+	mem_map_out_file(const char* sName, size_t length, bool preallocate = false) : mem_map_out_file()
+	{
+		open(sName, length, preallocate);
+	}
+	mem_map_out_file(const mem_map_out_file&) = delete;
+	mem_map_out_file& operator= (const mem_map_out_file&) = delete;
+	~mem_map_out_file()
+	{
+		close();
+	}
+	// preallocate reserves the disk blocks up front, so filling the mapping
+	// can't fault with SIGBUS part way through on a full or sparse-hostile filesystem.
+	bool open(const char* sName, size_t length, bool preallocate = false)
+	{
+		close();
+		fd_ = ::open(sName, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IWOTH | S_IROTH);
+		if (fd_ < 0)
+			return false;
+
+		sz_ = static_cast<off_t>(length * sizeof(T));
+		if (sz_ == 0)
+			return true;
+#if defined (__linux__)
+		// not every filesystem can, which is no reason to give up.
+		if (preallocate && ::fallocate(fd_, 0, 0, sz_) < 0 && errno != EOPNOTSUPP)
+		{
+			close();
+			return false;
+		}
+#else
+		(void)preallocate;
+#endif
+		if (::ftruncate(fd_, sz_) < 0)
+		{
+			close();
+			return false;
+		}
+		pv_ = ::mmap(0, sz_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+		if (pv_ == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	// flush dirty pages to the file. if wait is false only schedules the write.
+	bool sync(bool wait = true) const
+	{
+		if (pv_ == MAP_FAILED)
+			return true;
+		return ::msync(pv_, sz_, wait ? MS_SYNC : MS_ASYNC) == 0;
+	}
+
+	// off and len are in T, the range is widened to whole pages.
+	bool advise(mm_advice_t a, size_t off = 0, size_t len = size_t(-1)) const
+	{
+		if (pv_ == MAP_FAILED)
+			return true;
+		size_t const page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		size_t b = std::min(off * sizeof(T), static_cast<size_t>(sz_));
+		size_t e = len > (static_cast<size_t>(sz_) - b) / sizeof(T) ? static_cast<size_t>(sz_) : b + len * sizeof(T);
+		b -= b % page;
+		return ::madvise(static_cast<unsigned char*>(pv_) + b, e - b, to_madvise(a)) == 0;
+	}
+
+	size_t bytelength() const
+	{
+		return sz_;
+	}
+
+	size_t length() const
+	{
+		return sz_ / sizeof(T);
+	}
+
+	T* ptr() const
+	{
+		return pv_ == MAP_FAILED ? nullptr : reinterpret_cast<T*>(pv_);
+	}
+
+	operator T* () const
+	{
+		return ptr();
+	}
+
+	T* begin() const
+	{
+		return ptr();
+	}
+
+	T* end() const
+	{
+		return ptr() + length();
+	}
+
+	void close()
+	{
+		if (pv_ != MAP_FAILED)
+		{
+			::munmap(pv_, sz_);
+			pv_ = MAP_FAILED;
+		}
+		if (fd_ != -1)
+		{
+			::close(fd_);
+			fd_ = -1;
+		}
+		sz_ = 0;
+	}
+
+	operator bool() const
+	{
+		return fd_ != -1;
+	}
+};
+#endif